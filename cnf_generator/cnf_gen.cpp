@@ -0,0 +1,811 @@
+#include <algorithm>
+#include <atomic>
+#include <bitset>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include "engine_runner.h"
+
+#include <unistd.h>
+#endif
+
+// Writes DIMACS instances of four families: uniform random k-SAT, random
+// k-SAT with a planted solution, pigeonhole and Tseitin parity formulas on
+// random graphs. Every instance is a function of its seed alone. Random
+// formulas are cut into fixed blocks of clauses, each with its own stream,
+// so threads can fill blocks in parallel and the output does not depend on
+// how many there are. With --diff the instances are handed to the solvers
+// as they are written, and answers that contradict each other or the
+// family's known answer are reported.
+
+namespace fs = std::filesystem;
+
+namespace {
+
+enum class Family {
+    ksat,
+    planted,
+    pigeonhole,
+    parity
+};
+
+struct Options {
+    Family family = Family::ksat;
+    int vars = 100;
+    // 0 picks the satisfiability threshold for the clause width.
+    long long clauses = 0;
+    int width = 3;
+    int holes = 8;
+    int vertices = 50;
+    int degree = 3;
+    // Parity formulas get an odd total charge, which is unsatisfiable,
+    // unless this is set.
+    bool satisfiable = false;
+    uint64_t seed = 1;
+    int count = 1;
+    // 0 uses one thread per hardware thread.
+    int threads = 0;
+    std::string out;
+
+    bool diff = false;
+    // Comma-separated; split when the diff starts.
+    std::string engine_list = "cdcl,dpll";
+    std::string bin_dir;
+    double timeout_seconds = 10.0;
+    // A run is an outlier when it takes this many times the engine's median.
+    double outlier_factor = 10.0;
+    double noise_floor_ms = 5.0;
+    bool keep = false;
+};
+
+void print_usage() {
+    std::cerr << "Usage: ./cnf_gen [options]\n"
+              << "Writes random or structured CNF instances in DIMACS format.\n"
+              << "Families:\n"
+              << "  --family ksat          Uniform random k-SAT (default)\n"
+              << "  --family planted       Random k-SAT, keeping only clauses a hidden assignment\n"
+              << "                         satisfies; always SAT\n"
+              << "  --family pigeonhole    <holes> + 1 pigeons in <holes> holes; always UNSAT\n"
+              << "  --family parity        Tseitin parity constraints on a random connected graph;\n"
+              << "                         UNSAT, or SAT with --sat\n"
+              << "Options:\n"
+              << "  --vars <n>             Variables of ksat and planted (default: 100)\n"
+              << "  --clauses <n>          Clauses of ksat and planted (default: the threshold\n"
+              << "                         ratio for the width, 4.26n for 3-SAT)\n"
+              << "  -k <n>                 Literals per clause (default: 3)\n"
+              << "  --holes <n>            Holes of pigeonhole (default: 8)\n"
+              << "  --vertices <n>         Graph vertices of parity (default: 50)\n"
+              << "  --degree <n>           Maximum vertex degree of parity, 2 to 10 (default: 3)\n"
+              << "  --sat                  Make parity instances satisfiable\n"
+              << "  --seed <n>             Seed of the first instance; instance i uses seed + i\n"
+              << "                         (default: 1)\n"
+              << "  --count <n>            Number of instances (default: 1)\n"
+              << "  --threads <n>          Worker threads, 0 for one per hardware thread\n"
+              << "                         (default: 0)\n"
+              << "  --out <path>           Output file, standard output if omitted; with --count\n"
+              << "                         above 1 or --diff, a directory for the instances\n"
+              << "Differential testing:\n"
+              << "  --diff                 Run the engines on every instance and flag answers that\n"
+              << "                         disagree, crashes and outliers\n"
+              << "  --engines <list>       Comma-separated engines: cdcl, dpll, dp, resolution, sls\n"
+              << "                         (default: cdcl,dpll)\n"
+              << "  --bin-dir <dir>        Directory holding the solver executables\n"
+              << "                         (default: the directory of cnf_gen)\n"
+              << "  --timeout <seconds>    Per-run time limit (default: 10)\n"
+              << "  --outlier <factor>     Flag runs this many times slower than the engine's\n"
+              << "                         median (default: 10)\n"
+              << "  --noise-floor <ms>     Never flag runs faster than this (default: 5)\n"
+              << "  --keep                 Keep every instance, not just the flagged ones\n"
+              << "Instance names end in _sat or _unsat when the answer is known. With --diff the\n"
+              << "exit status is 2 if engines disagreed or failed.\n";
+}
+
+// Finalizer of splitmix64; turns related seeds into unrelated states.
+uint64_t mix(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+// xorshift64*, as in the local search solver.
+class Random {
+private:
+    uint64_t state;
+
+public:
+    explicit Random(uint64_t seed) : state(mix(seed)) {
+        if (state == 0) state = 1;
+    }
+
+    uint64_t next() {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 0x2545F4914F6CDD1Dull;
+    }
+
+    // Uniform in [0, bound) for bound < 2^32, by multiply and shift.
+    uint32_t below(uint32_t bound) { return (uint32_t)(((next() >> 32) * bound) >> 32); }
+};
+
+const char* family_name(Family family) {
+    switch (family) {
+        case Family::ksat: return "ksat";
+        case Family::planted: return "planted";
+        case Family::pigeonhole: return "pigeonhole";
+        case Family::parity: return "parity";
+    }
+    return "unknown";
+}
+
+bool random_family(Family family) {
+    return family == Family::ksat || family == Family::planted;
+}
+
+// Clause to variable ratios near the satisfiability threshold of random
+// k-SAT; 2^k ln 2 beyond the measured ones.
+long long default_clauses(int vars, int width) {
+    static const double ratios[] = {0.0, 1.0, 1.0, 4.26, 9.93, 21.12, 43.37, 87.79};
+    double ratio = width < 8 ? ratios[width] : std::ldexp(std::log(2.0), width);
+    return std::max(1LL, std::llround(ratio * vars));
+}
+
+// "SAT", "UNSAT", or "" for plain random k-SAT.
+const char* expected_result(const Options& options) {
+    switch (options.family) {
+        case Family::ksat: return "";
+        case Family::planted: return "SAT";
+        case Family::pigeonhole: return "UNSAT";
+        case Family::parity: return options.satisfiable ? "SAT" : "UNSAT";
+    }
+    return "";
+}
+
+std::string instance_name(const Options& options, uint64_t seed) {
+    std::ostringstream name;
+    name << family_name(options.family);
+    if (random_family(options.family)) {
+        name << "_k" << options.width << "_v" << options.vars << "_c" << options.clauses;
+    } else if (options.family == Family::pigeonhole) {
+        name << "_h" << options.holes;
+    } else {
+        name << "_v" << options.vertices << "_d" << options.degree;
+    }
+    name << "_s" << seed;
+    std::string expected = expected_result(options);
+    if (!expected.empty()) name << (expected == "SAT" ? "_sat" : "_unsat");
+    return name.str() + ".cnf";
+}
+
+// The command line that writes this instance alone.
+std::string reproduce_line(const Options& options, uint64_t seed) {
+    std::ostringstream line;
+    line << "c cnf_gen --family " << family_name(options.family);
+    if (random_family(options.family)) {
+        line << " -k " << options.width << " --vars " << options.vars << " --clauses " << options.clauses;
+    } else if (options.family == Family::pigeonhole) {
+        line << " --holes " << options.holes;
+    } else {
+        line << " --vertices " << options.vertices << " --degree " << options.degree
+             << (options.satisfiable ? " --sat" : "");
+    }
+    line << " --seed " << seed << "\n";
+    return line.str();
+}
+
+int decimal_digits(long long value) {
+    int digits = 1;
+    while (value >= 10) {
+        value /= 10;
+        digits++;
+    }
+    return digits;
+}
+
+// Writes a literal and the space after it; the caller reserves the room.
+inline char* put_literal(char* p, int literal) {
+    if (literal < 0) {
+        *p++ = '-';
+        literal = -literal;
+    }
+    char digits[10];
+    int n = 0;
+    do {
+        digits[n++] = (char)('0' + literal % 10);
+        literal /= 10;
+    } while (literal != 0);
+    while (n > 0) *p++ = digits[--n];
+    *p++ = ' ';
+    return p;
+}
+
+struct WriteStats {
+    long long clauses = 0;
+    size_t bytes = 0;
+};
+
+class OutputFile {
+private:
+    FILE* file;
+    bool owned;
+    bool failed = false;
+
+public:
+    OutputFile(FILE* file, bool owned) : file(file), owned(owned) {
+        std::setvbuf(file, nullptr, _IOFBF, 1 << 20);
+    }
+
+    void write(const char* data, size_t size) {
+        if (!failed && std::fwrite(data, 1, size, file) != size) failed = true;
+    }
+    void write(const std::string& text) { write(text.data(), text.size()); }
+
+    // Returns false if any write or the close failed.
+    bool finish() {
+        if (std::fflush(file) != 0) failed = true;
+        if (owned && std::fclose(file) != 0) failed = true;
+        file = nullptr;
+        return !failed;
+    }
+};
+
+constexpr long long clauses_per_block = 1 << 16;
+
+// Hidden assignment of the planted family, hashed from the seed so that no
+// thread needs a table of it.
+inline bool planted_value(uint64_t seed, int var) {
+    return mix(seed ^ ((uint64_t)var * 0xD1B54A32D192ED03ull)) >> 63;
+}
+
+// Appends clauses [block * clauses_per_block, ...) of a random instance.
+void generate_block(const Options& options, uint64_t seed, long long block, std::string& text,
+                    std::vector<int>& picked) {
+    long long first = block * clauses_per_block;
+    long long count = std::min(clauses_per_block, options.clauses - first);
+    int width = options.width;
+    text.resize((size_t)count * ((size_t)width * (decimal_digits(options.vars) + 2) + 2));
+    char* p = &text[0];
+
+    Random random(mix(seed) ^ (uint64_t)(block + 1));
+    picked.resize(width);
+    for (long long c = 0; c < count; c++) {
+        uint64_t signs;
+        while (true) {
+            // Distinct variables by rejection; widths are small next to vars.
+            for (int i = 0; i < width; i++) {
+                int var;
+                do var = (int)random.below((uint32_t)options.vars) + 1;
+                while (std::find(picked.begin(), picked.begin() + i, var) != picked.begin() + i);
+                picked[i] = var;
+            }
+            signs = random.next();
+            if (options.family != Family::planted) break;
+            bool satisfied = false;
+            for (int i = 0; i < width && !satisfied; i++) {
+                bool positive = ((signs >> (i & 63)) & 1) == 0;
+                satisfied = planted_value(seed, picked[i]) == positive;
+            }
+            if (satisfied) break;
+        }
+        for (int i = 0; i < width; i++) {
+            p = put_literal(p, ((signs >> (i & 63)) & 1) ? -picked[i] : picked[i]);
+        }
+        *p++ = '0';
+        *p++ = '\n';
+    }
+    text.resize((size_t)(p - text.data()));
+}
+
+// Blocks are filled by the workers and written strictly in order; a worker
+// never runs more than a window of blocks ahead of the writer, which bounds
+// the memory held in finished blocks.
+void write_random(OutputFile& out, const Options& options, uint64_t seed, int threads, WriteStats& stats) {
+    long long blocks = (options.clauses + clauses_per_block - 1) / clauses_per_block;
+    stats.clauses += options.clauses;
+    if (threads <= 1 || blocks <= 1) {
+        std::string text;
+        std::vector<int> picked;
+        for (long long block = 0; block < blocks; block++) {
+            generate_block(options, seed, block, text, picked);
+            out.write(text);
+            stats.bytes += text.size();
+        }
+        return;
+    }
+
+    size_t window = 2 * (size_t)threads;
+    std::vector<std::string> slots(window);
+    std::vector<char> filled(window, 0);
+    std::mutex mutex;
+    std::condition_variable changed;
+    long long next_block = 0;
+    long long written = 0;
+
+    auto work = [&]() {
+        std::string text;
+        std::vector<int> picked;
+        while (true) {
+            long long block;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [&]() { return next_block >= blocks || next_block < written + (long long)window; });
+                if (next_block >= blocks) return;
+                block = next_block++;
+            }
+            generate_block(options, seed, block, text, picked);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                slots[block % window].swap(text);
+                filled[block % window] = 1;
+            }
+            changed.notify_all();
+        }
+    };
+    std::vector<std::thread> pool;
+    for (int i = 0; i < threads; i++) pool.emplace_back(work);
+
+    std::string text;
+    for (long long block = 0; block < blocks; block++) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [&]() { return filled[block % window] != 0; });
+            text.swap(slots[block % window]);
+            filled[block % window] = 0;
+            written++;
+        }
+        changed.notify_all();
+        out.write(text);
+        stats.bytes += text.size();
+    }
+    for (std::thread& thread : pool) thread.join();
+}
+
+// Structured families are built in memory, 0-terminated clause after
+// clause, then scrambled and written.
+struct ClauseList {
+    int vars = 0;
+    long long clauses = 0;
+    std::vector<int> literals;
+
+    void add(std::initializer_list<int> clause) {
+        literals.insert(literals.end(), clause);
+        literals.push_back(0);
+        clauses++;
+    }
+};
+
+// Pigeon i sits in hole j when variable i * holes + j + 1 is true.
+void build_pigeonhole(int holes, ClauseList& list) {
+    int pigeons = holes + 1;
+    list.vars = pigeons * holes;
+    for (int i = 0; i < pigeons; i++) {
+        for (int j = 0; j < holes; j++) list.literals.push_back(i * holes + j + 1);
+        list.literals.push_back(0);
+        list.clauses++;
+    }
+    for (int j = 0; j < holes; j++) {
+        for (int a = 0; a < pigeons; a++) {
+            for (int b = a + 1; b < pigeons; b++) list.add({-(a * holes + j + 1), -(b * holes + j + 1)});
+        }
+    }
+}
+
+// One variable per edge. A random Hamiltonian cycle keeps the graph
+// connected, and the remaining degree - 2 stubs of every vertex are paired
+// at random, dropping self-loops. Every vertex requires the XOR of its edges
+// to equal its charge; on a connected graph that is satisfiable exactly
+// when the charges add up to an even number.
+void build_parity(int vertices, int degree, bool satisfiable, Random& random, ClauseList& list) {
+    std::vector<int> order(vertices);
+    for (int v = 0; v < vertices; v++) order[v] = v;
+    for (int i = vertices - 1; i > 0; i--) std::swap(order[i], order[random.below((uint32_t)i + 1)]);
+
+    std::vector<std::vector<int>> incident(vertices);
+    int edges = 0;
+    auto add_edge = [&](int u, int v) {
+        edges++;
+        incident[u].push_back(edges);
+        incident[v].push_back(edges);
+    };
+    for (int i = 0; i < vertices; i++) add_edge(order[i], order[(i + 1) % vertices]);
+
+    std::vector<int> stubs;
+    for (int v = 0; v < vertices; v++) stubs.insert(stubs.end(), (size_t)(degree - 2), v);
+    for (size_t i = stubs.size(); i > 1; i--) std::swap(stubs[i - 1], stubs[random.below((uint32_t)i)]);
+    for (size_t i = 0; i + 1 < stubs.size(); i += 2) {
+        if (stubs[i] != stubs[i + 1]) add_edge(stubs[i], stubs[i + 1]);
+    }
+    list.vars = edges;
+
+    std::vector<int> charge(vertices);
+    int total = 0;
+    for (int v = 0; v < vertices; v++) total += charge[v] = (int)(random.next() >> 63);
+    if ((total & 1) != (satisfiable ? 0 : 1)) charge[0] ^= 1;
+
+    // Forbids each assignment of the edges with the wrong parity.
+    for (int v = 0; v < vertices; v++) {
+        const std::vector<int>& edge = incident[v];
+        for (uint32_t mask = 0; mask < (1u << edge.size()); mask++) {
+            if ((int)(std::bitset<32>(mask).count() & 1) == charge[v]) continue;
+            for (size_t i = 0; i < edge.size(); i++) list.literals.push_back(((mask >> i) & 1) ? -edge[i] : edge[i]);
+            list.literals.push_back(0);
+            list.clauses++;
+        }
+    }
+}
+
+// Renames the variables by a random permutation and flips random signs,
+// which keeps the answer and the structure but not the shape of the file.
+void write_structured(OutputFile& out, const ClauseList& list, Random& random, WriteStats& stats) {
+    std::vector<int> rename(list.vars + 1);
+    for (int v = 1; v <= list.vars; v++) rename[v] = v;
+    for (int v = list.vars; v > 1; v--) std::swap(rename[v], rename[random.below((uint32_t)v) + 1]);
+    for (int v = 1; v <= list.vars; v++) {
+        if (random.next() >> 63) rename[v] = -rename[v];
+    }
+
+    std::string text;
+    size_t literal_bytes = (size_t)decimal_digits(list.vars) + 2;
+    text.resize(1 << 20);
+    char* p = &text[0];
+    for (int literal : list.literals) {
+        if ((size_t)(p - text.data()) + literal_bytes + 2 > text.size()) {
+            out.write(text.data(), (size_t)(p - text.data()));
+            stats.bytes += (size_t)(p - text.data());
+            p = &text[0];
+        }
+        if (literal == 0) {
+            *p++ = '0';
+            *p++ = '\n';
+        } else {
+            p = put_literal(p, literal < 0 ? -rename[-literal] : rename[literal]);
+        }
+    }
+    out.write(text.data(), (size_t)(p - text.data()));
+    stats.bytes += (size_t)(p - text.data());
+    stats.clauses += list.clauses;
+}
+
+void write_instance(OutputFile& out, const Options& options, uint64_t seed, int threads, WriteStats& stats) {
+    std::string header = reproduce_line(options, seed);
+    if (random_family(options.family)) {
+        header += "p cnf " + std::to_string(options.vars) + " " + std::to_string(options.clauses) + "\n";
+        out.write(header);
+        stats.bytes += header.size();
+        write_random(out, options, seed, threads, stats);
+        return;
+    }
+
+    Random random(seed);
+    ClauseList list;
+    if (options.family == Family::pigeonhole) build_pigeonhole(options.holes, list);
+    else build_parity(options.vertices, options.degree, options.satisfiable, random, list);
+    header += "p cnf " + std::to_string(list.vars) + " " + std::to_string(list.clauses) + "\n";
+    out.write(header);
+    stats.bytes += header.size();
+    write_structured(out, list, random, stats);
+}
+
+bool write_instance_file(const std::string& path, const Options& options, uint64_t seed, int threads,
+                         WriteStats& stats, std::string& error) {
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        error = "Could not open file " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    OutputFile out(file, true);
+    write_instance(out, options, seed, threads, stats);
+    if (!out.finish()) {
+        error = "Could not write " + path;
+        return false;
+    }
+    return true;
+}
+
+// Writes count instances into a directory. A single instance gets every
+// thread; several are spread over the threads one instance each.
+bool write_instances(const std::string& directory, const Options& options, int threads, WriteStats& stats,
+                     std::string& error) {
+    std::atomic<int> next{0};
+    std::mutex mutex;
+    auto work = [&](int instance_threads) {
+        WriteStats own;
+        std::string failure;
+        for (int i; (i = next++) < options.count;) {
+            uint64_t seed = options.seed + (uint64_t)i;
+            std::string path = (fs::path(directory) / instance_name(options, seed)).string();
+            if (!write_instance_file(path, options, seed, instance_threads, own, failure)) break;
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.clauses += own.clauses;
+        stats.bytes += own.bytes;
+        if (!failure.empty() && error.empty()) error = failure;
+    };
+
+    if (options.count == 1) {
+        work(threads);
+    } else {
+        std::vector<std::thread> pool;
+        for (int i = 0; i < std::min(threads, options.count); i++) pool.emplace_back(work, 1);
+        for (std::thread& thread : pool) thread.join();
+    }
+    return error.empty();
+}
+
+#ifndef _WIN32
+struct DiffRow {
+    std::string path;
+    std::string expected;
+    std::vector<RunResult> runs;
+    bool disagreement = false;
+    bool failure = false;
+    std::vector<bool> outlier;
+};
+
+// Time charged to a run for outlier detection: a timeout counts as the
+// full limit.
+double charged_ms(const RunResult& run, double timeout_seconds) {
+    return run.timed_out ? timeout_seconds * 1000.0 : run.solve_ms;
+}
+
+// Generates the instances and runs every engine on each as soon as it is
+// written; the workers take instances one at a time, so generation and
+// solving overlap. Returns the process exit status.
+int run_diff(const Options& options, const std::string& argv0, int threads) {
+    std::vector<Engine> engines;
+    std::string error;
+    if (!select_engines(split(options.engine_list, ','), engines, error)) {
+        std::cerr << "Error: " << error << "\n";
+        return 1;
+    }
+    std::string bin_dir = options.bin_dir.empty() ? fs::path(argv0).parent_path().string() : options.bin_dir;
+    if (bin_dir.empty()) bin_dir = ".";
+    std::vector<std::string> binaries;
+    for (const Engine& engine : engines) {
+        binaries.push_back((fs::path(bin_dir) / engine.binary).string());
+        if (access(binaries.back().c_str(), X_OK) != 0) {
+            std::cerr << "Error: " << binaries.back() << " not found\n";
+            return 1;
+        }
+    }
+
+    std::string directory = options.out;
+    bool temporary = directory.empty();
+    if (temporary) {
+        std::string pattern = (fs::temp_directory_path() / "cnf_gen_XXXXXX").string();
+        if (!mkdtemp(&pattern[0])) {
+            std::cerr << "Error: Could not create a temporary directory\n";
+            return 1;
+        }
+        directory = pattern;
+    } else {
+        std::error_code ignored;
+        fs::create_directories(directory, ignored);
+    }
+
+    std::vector<DiffRow> rows(options.count);
+    std::atomic<int> next{0};
+    std::mutex mutex;
+    auto work = [&]() {
+        for (int i; (i = next++) < options.count;) {
+            uint64_t seed = options.seed + (uint64_t)i;
+            DiffRow& row = rows[i];
+            row.path = (fs::path(directory) / instance_name(options, seed)).string();
+            row.expected = expected_result(options);
+            WriteStats stats;
+            std::string failure;
+            if (!write_instance_file(row.path, options, seed, 1, stats, failure)) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (error.empty()) error = failure;
+                return;
+            }
+            for (size_t e = 0; e < engines.size(); e++) {
+                row.runs.push_back(run_engine(binaries[e], engines[e].arguments, row.path, options.timeout_seconds));
+            }
+        }
+    };
+    std::vector<std::thread> pool;
+    for (int i = 0; i < std::min(threads, options.count); i++) pool.emplace_back(work);
+    for (std::thread& thread : pool) thread.join();
+    if (!error.empty()) {
+        std::cerr << "Error: " << error << "\n";
+        return 1;
+    }
+
+    std::vector<double> medians;
+    for (size_t e = 0; e < engines.size(); e++) {
+        std::vector<double> times;
+        for (const DiffRow& row : rows) {
+            if (row.runs[e].solve_ms >= 0.0 || row.runs[e].timed_out) {
+                times.push_back(charged_ms(row.runs[e], options.timeout_seconds));
+            }
+        }
+        medians.push_back(median(times));
+    }
+
+    std::cout << std::left << std::setw(44) << "instance" << std::setw(9) << "expected";
+    for (const Engine& engine : engines) std::cout << std::setw(22) << engine.name;
+    std::cout << "note\n";
+
+    int disagreements = 0;
+    int failures = 0;
+    int outliers = 0;
+    for (DiffRow& row : rows) {
+        bool sat = row.expected == "SAT";
+        bool unsat = row.expected == "UNSAT";
+        row.outlier.assign(engines.size(), false);
+        for (size_t e = 0; e < engines.size(); e++) {
+            const RunResult& run = row.runs[e];
+            sat |= run.result == "SAT";
+            unsat |= run.result == "UNSAT";
+            if (run.result == "ERROR") row.failure = true;
+            double ms = charged_ms(run, options.timeout_seconds);
+            if (ms >= options.noise_floor_ms && ms > options.outlier_factor * medians[e]) {
+                row.outlier[e] = true;
+                outliers++;
+            }
+        }
+        row.disagreement = sat && unsat;
+        disagreements += row.disagreement;
+        failures += row.failure;
+
+        std::string note;
+        if (row.disagreement) note = "DISAGREEMENT";
+        if (row.failure) note += std::string(note.empty() ? "" : "; ") + "FAILED";
+        if (std::find(row.outlier.begin(), row.outlier.end(), true) != row.outlier.end()) {
+            note += std::string(note.empty() ? "" : "; ") + "OUTLIER";
+        }
+
+        std::cout << std::left << std::setw(44) << fs::path(row.path).filename().string() << std::setw(9)
+                  << (row.expected.empty() ? "-" : row.expected);
+        for (size_t e = 0; e < engines.size(); e++) {
+            std::ostringstream cell;
+            cell << row.runs[e].result;
+            if (row.runs[e].solve_ms >= 0.0) cell << " " << std::fixed << std::setprecision(1) << row.runs[e].solve_ms;
+            if (row.outlier[e]) cell << "*";
+            std::cout << std::setw(22) << cell.str();
+        }
+        std::cout << note << "\n";
+
+        if (!options.keep && note.empty()) {
+            std::error_code ignored;
+            fs::remove(row.path, ignored);
+        }
+    }
+
+    std::cout << "c medians:";
+    for (size_t e = 0; e < engines.size(); e++) {
+        std::cout << " " << engines[e].name << " " << std::fixed << std::setprecision(3) << medians[e] << " ms";
+    }
+    std::cout << "\nc " << rows.size() << " instances, " << disagreements << " disagreements, " << failures
+              << " failures, " << outliers << " outliers (* over " << std::defaultfloat << options.outlier_factor
+              << "x the median)\n";
+    std::error_code ignored;
+    if (temporary && fs::is_empty(directory, ignored)) fs::remove(directory, ignored);
+    else std::cout << "c instances kept in " << directory << "\n";
+    return (disagreements > 0 || failures > 0) ? 2 : 0;
+}
+#endif
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "-h" || arg == "--help") {
+            print_usage();
+            return 0;
+        } else if (arg == "--family" && has_value) {
+            std::string value = argv[++i];
+            if (value == "ksat") options.family = Family::ksat;
+            else if (value == "planted") options.family = Family::planted;
+            else if (value == "pigeonhole") options.family = Family::pigeonhole;
+            else if (value == "parity") options.family = Family::parity;
+            else {
+                std::cerr << "Error: Unknown family " << value << "\n";
+                return 1;
+            }
+        }
+        else if (arg == "--vars" && has_value) options.vars = std::atoi(argv[++i]);
+        else if (arg == "--clauses" && has_value) options.clauses = std::atoll(argv[++i]);
+        else if (arg == "-k" && has_value) options.width = std::atoi(argv[++i]);
+        else if (arg == "--holes" && has_value) options.holes = std::atoi(argv[++i]);
+        else if (arg == "--vertices" && has_value) options.vertices = std::atoi(argv[++i]);
+        else if (arg == "--degree" && has_value) options.degree = std::atoi(argv[++i]);
+        else if (arg == "--sat") options.satisfiable = true;
+        else if (arg == "--seed" && has_value) options.seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--count" && has_value) options.count = std::atoi(argv[++i]);
+        else if (arg == "--threads" && has_value) options.threads = std::max(0, std::atoi(argv[++i]));
+        else if (arg == "--out" && has_value) options.out = argv[++i];
+        else if (arg == "--diff") options.diff = true;
+        else if (arg == "--engines" && has_value) options.engine_list = argv[++i];
+        else if (arg == "--bin-dir" && has_value) options.bin_dir = argv[++i];
+        else if (arg == "--timeout" && has_value) options.timeout_seconds = std::max(0.001, std::atof(argv[++i]));
+        else if (arg == "--outlier" && has_value) options.outlier_factor = std::atof(argv[++i]);
+        else if (arg == "--noise-floor" && has_value) options.noise_floor_ms = std::atof(argv[++i]);
+        else if (arg == "--keep") options.keep = true;
+        else {
+            std::cerr << "Error: Unknown option " << arg << "\n";
+            print_usage();
+            return 1;
+        }
+    }
+
+    std::string invalid;
+    if (options.count < 1) invalid = "--count must be at least 1";
+    else if (random_family(options.family) && (options.width < 1 || options.vars < options.width)) {
+        invalid = "-k must be between 1 and --vars";
+    } else if (random_family(options.family) && options.clauses < 0) invalid = "--clauses must not be negative";
+    else if (options.family == Family::pigeonhole && (options.holes < 1 || options.holes > 4000)) {
+        invalid = "--holes must be between 1 and 4000";
+    } else if (options.family == Family::parity && (options.degree < 2 || options.degree > 10)) {
+        invalid = "--degree must be between 2 and 10";
+    } else if (options.family == Family::parity && options.vertices < 2) invalid = "--vertices must be at least 2";
+    if (!invalid.empty()) {
+        std::cerr << "Error: " << invalid << "\n";
+        return 1;
+    }
+    if (random_family(options.family) && options.clauses == 0) {
+        options.clauses = default_clauses(options.vars, options.width);
+    }
+    int threads = options.threads > 0 ? options.threads : (int)std::max(1u, std::thread::hardware_concurrency());
+
+    if (options.diff) {
+#ifdef _WIN32
+        std::cerr << "Error: --diff starts the solvers through POSIX calls and is not supported on this platform\n";
+        return 1;
+#else
+        return run_diff(options, argv[0], threads);
+#endif
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    WriteStats stats;
+    std::string error;
+    bool written;
+    if (options.count == 1 && options.out.empty()) {
+        OutputFile out(stdout, false);
+        write_instance(out, options, options.seed, threads, stats);
+        written = out.finish();
+        if (!written) error = "Could not write to standard output";
+    } else if (options.count == 1 && !fs::is_directory(options.out)) {
+        written = write_instance_file(options.out, options, options.seed, threads, stats, error);
+    } else {
+        if (options.out.empty()) {
+            std::cerr << "Error: --count above 1 needs --out <directory>\n";
+            return 1;
+        }
+        std::error_code ignored;
+        fs::create_directories(options.out, ignored);
+        written = write_instances(options.out, options, threads, stats, error);
+    }
+    if (!written) {
+        std::cerr << "Error: " << error << "\n";
+        return 1;
+    }
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    double megabytes = stats.bytes / 1048576.0;
+    std::cerr << "c wrote " << options.count << (options.count == 1 ? " instance, " : " instances, ") << stats.clauses
+              << " clauses, " << std::fixed << std::setprecision(1) << megabytes << " MB in " << ms << " ms ("
+              << (ms > 0.0 ? megabytes * 1000.0 / ms : 0.0) << " MB/s)\n";
+    return 0;
+}
@@ -0,0 +1,214 @@
+#include "dimacs_reader.h"
+#include "clause_kernel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Classifies every clause of a formula under a random partial assignment,
+// once literal by literal over the CSR formula the way the solvers used to,
+// and once per ClauseKernel instruction set, and reports clause throughput.
+// All paths must agree on every clause.
+
+namespace {
+
+struct Options {
+    std::string input_path;
+    int variables = 100000;
+    size_t clauses = 420000;
+    int width = 3;
+    int rounds = 50;
+    double assigned_fraction = 0.7;
+    unsigned seed = 1;
+};
+
+void print_usage() {
+    std::cerr << "Usage: ./clause_kernel_bench [options] [input_file.cnf | -]\n"
+              << "Without an input file a random k-CNF formula is generated.\n"
+              << "Options:\n"
+              << "  --vars <n>          Variables of the random formula (default: 100000)\n"
+              << "  --clauses <n>       Clauses of the random formula (default: 420000)\n"
+              << "  --width <k>         Literals per random clause, 1 to 4 (default: 3)\n"
+              << "  --rounds <n>        Assignments timed per path (default: 50)\n"
+              << "  --assigned <frac>   Fraction of variables assigned (default: 0.7)\n"
+              << "  --seed <n>          Random seed (default: 1)\n";
+}
+
+void generate_formula(const Options& options, DimacsFormula& formula) {
+    std::mt19937 rng(options.seed);
+    std::uniform_int_distribution<int> variable(1, options.variables);
+    formula.variable_count = options.variables;
+    formula.literals.reserve(options.clauses * options.width);
+    // Distinct variables per clause, so every clause is exactly width wide.
+    for (size_t i = 0; i < options.clauses; i++) {
+        size_t start = formula.literals.size();
+        while (formula.literals.size() - start < (size_t)options.width) {
+            int v = variable(rng);
+            bool repeated = false;
+            for (size_t j = start; j < formula.literals.size(); j++) repeated |= (std::abs(formula.literals[j]) == v);
+            if (!repeated) formula.literals.push_back((rng() & 1) ? v : -v);
+        }
+        formula.clause_starts.push_back((uint32_t)formula.literals.size());
+    }
+}
+
+// The per-literal loop the kernel replaces: one branch on the value of each
+// literal, stopping at the first true one. Expects remove_duplicate_literals
+// to have run, as a repeated literal would count twice against the width.
+ClassifyCounts classify_csr(const DimacsFormula& formula, const std::vector<int>& model, uint8_t* status) {
+    ClassifyCounts counts;
+    for (size_t c = 0; c < formula.clause_count(); c++) {
+        bool satisfied = false;
+        size_t false_count = 0;
+        size_t width = formula.clause_size(c);
+        for (const int* lit = formula.clause_begin(c); lit != formula.clause_end(c); ++lit) {
+            int value = model[std::abs(*lit) - 1];
+            if (value == -1) continue;
+            if ((*lit > 0) == (value == 1)) {
+                satisfied = true;
+                break;
+            }
+            false_count++;
+        }
+        if (satisfied) {
+            status[c] = CLAUSE_SATISFIED;
+            counts.satisfied++;
+        } else if (false_count == width) {
+            status[c] = CLAUSE_CONFLICT;
+            counts.conflict++;
+        } else if (false_count + 1 == width) {
+            status[c] = CLAUSE_UNIT;
+            counts.unit++;
+        } else {
+            status[c] = CLAUSE_UNRESOLVED;
+            counts.unresolved++;
+        }
+    }
+    return counts;
+}
+
+template <int K>
+int run(const Options& options, const DimacsFormula& formula) {
+    std::mt19937 rng(options.seed + 1);
+    std::uniform_real_distribution<double> coin(0.0, 1.0);
+    std::vector<std::vector<int>> models(options.rounds, std::vector<int>(formula.variable_count));
+    for (std::vector<int>& model : models) {
+        for (int& value : model) value = (coin(rng) < options.assigned_fraction) ? (int)(rng() & 1) : -1;
+    }
+
+    ClauseKernel<K> kernel;
+    std::string error;
+    if (!kernel.load(formula, error)) {
+        std::cerr << "Error: " << error << "\n";
+        return 1;
+    }
+    const size_t n = formula.clause_count();
+    std::vector<uint8_t> expected(n * options.rounds);
+    std::vector<uint8_t> status(n);
+
+    auto report = [&](const char* name, double ms, double baseline_ms) {
+        double rate = (double)n * options.rounds / (ms / 1000.0) / 1e6;
+        std::cout << std::left << std::setw(8) << name << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(10) << ms << " ms " << std::setw(10) << rate << " Mclauses/s";
+        if (baseline_ms > 0.0) std::cout << "  x" << baseline_ms / ms;
+        std::cout << "\n";
+    };
+
+    std::cout << "c " << n << " clauses of width <= " << K << ", " << formula.variable_count << " variables, "
+              << options.rounds << " rounds\n";
+
+    ClassifyCounts reference;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int r = 0; r < options.rounds; r++) {
+        ClassifyCounts counts = classify_csr(formula, models[r], expected.data() + n * r);
+        if (r == 0) reference = counts;
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    double csr_ms = std::chrono::duration<double, std::milli>(end - start).count();
+    report("csr", csr_ms, 0.0);
+
+    const KernelIsa best = best_kernel_isa();
+    for (KernelIsa isa : {KernelIsa::scalar, KernelIsa::sse2, KernelIsa::avx2}) {
+        if (isa > best) break;
+        double ms = 0.0;
+        for (int r = 0; r < options.rounds; r++) {
+            // Loading the assignment is not part of what is being measured.
+            kernel.set_assignment(models[r]);
+            auto round_start = std::chrono::high_resolution_clock::now();
+            kernel.classify(status.data(), isa);
+            auto round_end = std::chrono::high_resolution_clock::now();
+            ms += std::chrono::duration<double, std::milli>(round_end - round_start).count();
+
+            for (size_t c = 0; c < n; c++) {
+                if (status[c] != expected[n * r + c]) {
+                    std::cerr << "Error: " << kernel_isa_name(isa) << " disagrees with csr on clause " << c + 1
+                              << " in round " << r << "\n";
+                    return 1;
+                }
+            }
+        }
+        report(kernel_isa_name(isa), ms, csr_ms);
+    }
+
+    std::cout << "c first round: " << reference.satisfied << " satisfied, " << reference.unit << " unit, "
+              << reference.conflict << " conflicting, " << reference.unresolved << " unresolved\n";
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--vars" && i + 1 < argc) options.variables = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--clauses" && i + 1 < argc) options.clauses = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--width" && i + 1 < argc) options.width = std::atoi(argv[++i]);
+        else if (arg == "--rounds" && i + 1 < argc) options.rounds = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--assigned" && i + 1 < argc) options.assigned_fraction = std::stod(argv[++i]);
+        else if (arg == "--seed" && i + 1 < argc) options.seed = (unsigned)std::stoul(argv[++i]);
+        else if (arg == "-h" || arg == "--help") {
+            print_usage();
+            return 0;
+        } else if (arg.size() > 1 && arg[0] == '-') {
+            std::cerr << "Error: Unknown option " << arg << "\n";
+            print_usage();
+            return 1;
+        } else options.input_path = arg;
+    }
+
+    DimacsFormula formula;
+    if (options.input_path.empty()) {
+        if (options.width < 1 || options.width > 4 || options.width > options.variables) {
+            std::cerr << "Error: --width must be between 1 and 4 and at most --vars\n";
+            return 1;
+        }
+        generate_formula(options, formula);
+    } else {
+        std::string error;
+        if (!read_dimacs(options.input_path, formula, error)) {
+            std::cerr << "Error: " << error << "\n";
+            return 1;
+        }
+    }
+
+    // Both paths see the clauses the way the kernel stores them.
+    remove_duplicate_literals(formula);
+    switch (max_clause_width(formula)) {
+        case 0:
+        case 1: return run<1>(options, formula);
+        case 2: return run<2>(options, formula);
+        case 3: return run<3>(options, formula);
+        case 4: return run<4>(options, formula);
+        default:
+            std::cerr << "Error: the kernel handles clauses of up to 4 literals, this formula has "
+                      << max_clause_width(formula) << "\n";
+            return 1;
+    }
+}
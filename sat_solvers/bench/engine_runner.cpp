@@ -0,0 +1,156 @@
+#include "engine_runner.h"
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <sstream>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+const std::vector<Engine>& known_engines() {
+    static const std::vector<Engine> engines = {
+        {"cdcl", "cdcl_solver", {"--stats"}},
+        {"dpll", "dpll_solver", {"--stats"}},
+        {"dp", "dp_solver", {"--stats"}},
+        {"resolution", "resolution_solver", {"--stats"}},
+        {"sls", "sls_solver", {"--stats"}},
+    };
+    return engines;
+}
+
+bool select_engines(const std::vector<std::string>& names, std::vector<Engine>& engines, std::string& error) {
+    engines.clear();
+    if (names.empty()) engines = known_engines();
+    for (const std::string& name : names) {
+        auto known = std::find_if(known_engines().begin(), known_engines().end(),
+                                  [&name](const Engine& engine) { return engine.name == name; });
+        if (known == known_engines().end()) {
+            error = "Unknown engine " + name;
+            return false;
+        }
+        engines.push_back(*known);
+    }
+    return true;
+}
+
+std::vector<std::string> split(const std::string& text, char separator) {
+    std::vector<std::string> parts;
+    std::stringstream stream(text);
+    std::string part;
+    while (std::getline(stream, part, separator)) parts.push_back(part);
+    return parts;
+}
+
+double median(std::vector<double> values) {
+    if (values.empty()) return 0.0;
+    std::sort(values.begin(), values.end());
+    size_t n = values.size();
+    return (n % 2) ? values[n / 2] : (values[n / 2 - 1] + values[n / 2]) / 2.0;
+}
+
+void parse_output(const std::string& output, RunResult& run) {
+    std::istringstream lines(output);
+    std::string line;
+    bool have_result = false;
+    while (std::getline(lines, line)) {
+        std::istringstream words(line);
+        std::string first, second, third;
+        words >> first;
+        if (!have_result && (first == "SAT" || first == "UNSAT" || first == "UNKNOWN")) {
+            double ms;
+            if (words >> second >> ms && second == "in") {
+                run.result = first;
+                run.solve_ms = ms;
+                have_result = true;
+            }
+        } else if (first == "c") {
+            words >> second;
+            if (second == "parsed") {
+                double megabytes, ms;
+                if (words >> megabytes >> third >> third >> ms) run.parse_ms = ms;
+            } else if (second == "conflicts:") {
+                words >> run.conflicts;
+            } else if (second == "propagations:") {
+                words >> run.propagations;
+            }
+        }
+    }
+}
+
+RunResult run_engine(const std::string& binary, const std::vector<std::string>& arguments,
+                     const std::string& instance, double timeout_seconds) {
+    RunResult run;
+    int pipe_fds[2];
+    auto start = std::chrono::steady_clock::now();
+    pid_t pid;
+    {
+        // Runs may start from several threads at once. A child forked by
+        // one of them must not inherit another run's write end, or that
+        // reader sees no end of file until the unrelated child exits. The
+        // lock keeps every pipe marked close-on-exec before any fork.
+        static std::mutex spawn_mutex;
+        std::lock_guard<std::mutex> lock(spawn_mutex);
+        if (pipe(pipe_fds) != 0) return run;
+        fcntl(pipe_fds[0], F_SETFD, FD_CLOEXEC);
+        fcntl(pipe_fds[1], F_SETFD, FD_CLOEXEC);
+        pid = fork();
+    }
+    if (pid < 0) {
+        close(pipe_fds[0]);
+        close(pipe_fds[1]);
+        return run;
+    }
+    if (pid == 0) {
+        dup2(pipe_fds[1], STDOUT_FILENO);
+        close(pipe_fds[0]);
+        close(pipe_fds[1]);
+        std::vector<char*> argv;
+        argv.push_back(const_cast<char*>(binary.c_str()));
+        for (const std::string& argument : arguments) argv.push_back(const_cast<char*>(argument.c_str()));
+        argv.push_back(const_cast<char*>(instance.c_str()));
+        argv.push_back(nullptr);
+        execv(binary.c_str(), argv.data());
+        _exit(127);
+    }
+    close(pipe_fds[1]);
+
+    auto deadline = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                std::chrono::duration<double>(timeout_seconds));
+    std::string output;
+    char buffer[4096];
+    while (true) {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        if (remaining.count() <= 0) {
+            run.timed_out = true;
+            kill(pid, SIGKILL);
+            break;
+        }
+        pollfd descriptor{pipe_fds[0], POLLIN, 0};
+        int ready = poll(&descriptor, 1, (int)std::min<long long>(remaining.count(), 100));
+        if (ready < 0) break;
+        if (ready == 0) continue;
+        ssize_t bytes = read(pipe_fds[0], buffer, sizeof(buffer));
+        if (bytes <= 0) break;
+        output.append(buffer, (size_t)bytes);
+    }
+    close(pipe_fds[0]);
+
+    int status = 0;
+    rusage usage{};
+    wait4(pid, &status, 0, &usage);
+    auto end = std::chrono::steady_clock::now();
+    run.wall_ms = std::chrono::duration<double, std::milli>(end - start).count();
+    run.peak_rss_kb = usage.ru_maxrss;
+
+    if (run.timed_out) {
+        run.result = "TIMEOUT";
+        return run;
+    }
+    if (WIFEXITED(status) && WEXITSTATUS(status) == 0) parse_output(output, run);
+    return run;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Starts solver executables as child processes and reads back what they
+// print. Shared by sat_bench and the differential mode of cnf_gen; POSIX
+// only.
+
+struct Engine {
+    std::string name;
+    std::string binary;
+    std::vector<std::string> arguments;
+};
+
+// cdcl, dpll, dp, resolution and sls, each run with --stats.
+const std::vector<Engine>& known_engines();
+
+// Resolves a comma-separated list of engine names; an empty list selects
+// every engine. Returns false with error set on an unknown name.
+bool select_engines(const std::vector<std::string>& names, std::vector<Engine>& engines, std::string& error);
+
+struct RunResult {
+    // SAT, UNSAT or UNKNOWN as printed; TIMEOUT or ERROR otherwise.
+    std::string result = "ERROR";
+    double solve_ms = -1.0;
+    double parse_ms = -1.0;
+    double wall_ms = 0.0;
+    long peak_rss_kb = 0;
+    long long conflicts = -1;
+    long long propagations = -1;
+    bool timed_out = false;
+};
+
+// Picks the numbers out of the solver's report:
+//   SAT|UNSAT|UNKNOWN in <ms> ms
+//   c parsed <MB> MB in <ms> ms (...)
+//   c conflicts: <n>
+//   c propagations: <n>
+void parse_output(const std::string& output, RunResult& run);
+
+// Splits text at every separator: "cdcl,dpll" gives "cdcl" and "dpll".
+std::vector<std::string> split(const std::string& text, char separator);
+
+// Median of the values, 0 if there are none.
+double median(std::vector<double> values);
+
+// Runs one solver on instance with stdout captured, killing it at the
+// deadline. Peak RSS comes from the kernel.
+RunResult run_engine(const std::string& binary, const std::vector<std::string>& arguments,
+                     const std::string& instance, double timeout_seconds);
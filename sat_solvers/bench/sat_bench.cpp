@@ -0,0 +1,377 @@
+#include "engine_runner.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <unistd.h>
+
+// Runs solver executables over a set of CNF instances and records how they
+// did. Every engine runs as a child process, so a crash or a timeout only
+// costs that run, and its peak RSS comes from the kernel. Solve and parse
+// times, conflicts and propagations are read from the lines the solvers
+// print. Results go to a table on standard output and optionally to CSV or
+// JSON; a CSV from an earlier run serves as the baseline for regressions.
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct Options {
+    std::vector<std::string> inputs;
+    std::vector<std::string> engine_names;
+    std::string bin_dir;
+    int repeat = 3;
+    int warmup = 1;
+    double timeout_seconds = 10.0;
+    std::string csv_path;
+    std::string json_path;
+    std::string baseline_path;
+    double threshold_percent = 10.0;
+    // Medians below this many milliseconds are too noisy to flag.
+    double noise_floor_ms = 1.0;
+};
+
+struct Measurement {
+    std::string engine;
+    std::string instance;
+    std::string expected;
+    std::string result;
+    // Set when repetitions answered both SAT and UNSAT.
+    bool inconsistent = false;
+    int runs = 0;
+    double solve_median = -1.0;
+    double solve_min = -1.0;
+    double solve_max = -1.0;
+    double solve_stddev = 0.0;
+    double parse_ms = -1.0;
+    double wall_ms = 0.0;
+    long peak_rss_kb = 0;
+    long long conflicts = -1;
+    long long propagations = -1;
+};
+
+void print_usage() {
+    std::cerr << "Usage: ./sat_bench [options] <directory | file.cnf>...\n"
+              << "Runs each engine on every .cnf file found (directories are searched recursively).\n"
+              << "Options:\n"
+              << "  --engines <list>       Comma-separated engines: cdcl, dpll, dp, resolution, sls\n"
+              << "                         (default: all of them)\n"
+              << "  --bin-dir <dir>        Directory holding the solver executables\n"
+              << "                         (default: the directory of sat_bench)\n"
+              << "  --repeat <n>           Measured runs per engine and instance (default: 3)\n"
+              << "  --warmup <n>           Unmeasured runs before them (default: 1)\n"
+              << "  --timeout <seconds>    Per-run time limit (default: 10)\n"
+              << "  --csv <file>           Write the results as CSV\n"
+              << "  --json <file>          Write the results as JSON\n"
+              << "  --baseline <file.csv>  Compare against the CSV of an earlier run\n"
+              << "  --threshold <percent>  Flag solve time medians this much slower than the\n"
+              << "                         baseline (default: 10)\n"
+              << "  --noise-floor <ms>     Ignore medians below this (default: 1)\n"
+              << "Exits with status 2 when a run gives a wrong answer, crashes or exits with an\n"
+              << "error, answers differently across repetitions, or regresses.\n";
+}
+
+// The instance names in cnf_files/tests end in _sat or _unsat.
+std::string expected_result(const std::string& path) {
+    std::string stem = fs::path(path).stem().string();
+    auto ends_with = [&stem](const std::string& suffix) {
+        return stem.size() >= suffix.size() && stem.compare(stem.size() - suffix.size(), suffix.size(), suffix) == 0;
+    };
+    if (ends_with("_unsat")) return "UNSAT";
+    if (ends_with("_sat")) return "SAT";
+    return "";
+}
+
+struct Instance {
+    std::string path;
+    // Relative to the directory it was found in, or the file name, so that
+    // baselines match no matter where the harness is started from.
+    std::string name;
+
+    bool operator<(const Instance& other) const { return name < other.name; }
+    bool operator==(const Instance& other) const { return name == other.name; }
+};
+
+std::vector<Instance> collect_instances(const std::vector<std::string>& inputs) {
+    std::vector<Instance> instances;
+    for (const std::string& input : inputs) {
+        std::error_code error;
+        if (fs::is_directory(input, error)) {
+            for (const auto& entry : fs::recursive_directory_iterator(input, error)) {
+                if (entry.is_regular_file() && entry.path().extension() == ".cnf") {
+                    instances.push_back({entry.path().string(), entry.path().lexically_relative(input).generic_string()});
+                }
+            }
+        } else {
+            instances.push_back({input, fs::path(input).filename().string()});
+        }
+    }
+    std::sort(instances.begin(), instances.end());
+    instances.erase(std::unique(instances.begin(), instances.end()), instances.end());
+    return instances;
+}
+
+Measurement measure(const Engine& engine, const std::string& binary, const Instance& instance,
+                    const Options& options) {
+    Measurement measurement;
+    measurement.engine = engine.name;
+    measurement.instance = instance.name;
+    measurement.expected = expected_result(instance.path);
+
+    for (int i = 0; i < options.warmup; i++) {
+        if (run_engine(binary, engine.arguments, instance.path, options.timeout_seconds).timed_out) break;
+    }
+
+    std::vector<double> solve_times;
+    double parse_total = 0.0;
+    double wall_total = 0.0;
+    int parse_runs = 0;
+    std::string first_answer;
+    for (int i = 0; i < options.repeat; i++) {
+        RunResult run = run_engine(binary, engine.arguments, instance.path, options.timeout_seconds);
+        measurement.runs++;
+        measurement.peak_rss_kb = std::max(measurement.peak_rss_kb, run.peak_rss_kb);
+        wall_total += run.wall_ms;
+        bool answered = run.result == "SAT" || run.result == "UNSAT";
+        if (answered && first_answer.empty()) first_answer = run.result;
+        if (answered && run.result != first_answer) measurement.inconsistent = true;
+        if (measurement.result.empty() || !answered) measurement.result = run.result;
+        // A run that times out or fails will do so again; the rest would
+        // only cost time.
+        if (run.solve_ms < 0.0) break;
+        solve_times.push_back(run.solve_ms);
+        if (run.parse_ms >= 0.0) {
+            parse_total += run.parse_ms;
+            parse_runs++;
+        }
+        measurement.conflicts = run.conflicts;
+        measurement.propagations = run.propagations;
+    }
+    measurement.wall_ms = wall_total / measurement.runs;
+    if (parse_runs > 0) measurement.parse_ms = parse_total / parse_runs;
+
+    if (!solve_times.empty()) {
+        std::sort(solve_times.begin(), solve_times.end());
+        size_t n = solve_times.size();
+        measurement.solve_median = median(solve_times);
+        measurement.solve_min = solve_times.front();
+        measurement.solve_max = solve_times.back();
+        double mean = 0.0;
+        for (double t : solve_times) mean += t;
+        mean /= (double)n;
+        double variance = 0.0;
+        for (double t : solve_times) variance += (t - mean) * (t - mean);
+        measurement.solve_stddev = (n > 1) ? std::sqrt(variance / (double)(n - 1)) : 0.0;
+    }
+    return measurement;
+}
+
+bool wrong_answer(const Measurement& m) {
+    return !m.expected.empty() && (m.result == "SAT" || m.result == "UNSAT") && m.result != m.expected;
+}
+
+const char* csv_header =
+    "engine,instance,expected,result,runs,solve_ms_median,solve_ms_min,solve_ms_max,solve_ms_stddev,"
+    "parse_ms,wall_ms,peak_rss_kb,conflicts,propagations";
+
+void write_csv(std::ostream& out, const std::vector<Measurement>& measurements) {
+    out << csv_header << "\n" << std::fixed << std::setprecision(3);
+    for (const Measurement& m : measurements) {
+        out << m.engine << "," << m.instance << "," << m.expected << "," << m.result << "," << m.runs << ","
+            << m.solve_median << "," << m.solve_min << "," << m.solve_max << "," << m.solve_stddev << ","
+            << m.parse_ms << "," << m.wall_ms << "," << m.peak_rss_kb << "," << m.conflicts << ","
+            << m.propagations << "\n";
+    }
+}
+
+std::string json_string(const std::string& text) {
+    std::string quoted = "\"";
+    for (char ch : text) {
+        if (ch == '"' || ch == '\\') quoted += '\\';
+        quoted += ch;
+    }
+    return quoted + "\"";
+}
+
+void write_json(std::ostream& out, const std::vector<Measurement>& measurements) {
+    out << "[\n" << std::fixed << std::setprecision(3);
+    for (size_t i = 0; i < measurements.size(); i++) {
+        const Measurement& m = measurements[i];
+        out << "  {\"engine\": " << json_string(m.engine) << ", \"instance\": " << json_string(m.instance)
+            << ", \"expected\": " << json_string(m.expected) << ", \"result\": " << json_string(m.result)
+            << ", \"runs\": " << m.runs << ", \"solve_ms_median\": " << m.solve_median
+            << ", \"solve_ms_min\": " << m.solve_min << ", \"solve_ms_max\": " << m.solve_max
+            << ", \"solve_ms_stddev\": " << m.solve_stddev << ", \"parse_ms\": " << m.parse_ms
+            << ", \"wall_ms\": " << m.wall_ms << ", \"peak_rss_kb\": " << m.peak_rss_kb
+            << ", \"conflicts\": " << m.conflicts << ", \"propagations\": " << m.propagations << "}"
+            << (i + 1 < measurements.size() ? "," : "") << "\n";
+    }
+    out << "]\n";
+}
+
+// Baseline rows by engine and instance: result and median solve time.
+bool read_baseline(const std::string& path, std::map<std::pair<std::string, std::string>, std::pair<std::string, double>>& rows) {
+    std::ifstream in(path);
+    if (!in.is_open()) return false;
+    std::string line;
+    std::getline(in, line);
+    while (std::getline(in, line)) {
+        std::vector<std::string> fields = split(line, ',');
+        if (fields.size() < 6) continue;
+        rows[{fields[0], fields[1]}] = {fields[3], std::atof(fields[5].c_str())};
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "-h" || arg == "--help") {
+            print_usage();
+            return 0;
+        } else if (arg == "--engines" && has_value) options.engine_names = split(argv[++i], ',');
+        else if (arg == "--bin-dir" && has_value) options.bin_dir = argv[++i];
+        else if (arg == "--repeat" && has_value) options.repeat = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--warmup" && has_value) options.warmup = std::max(0, std::atoi(argv[++i]));
+        else if (arg == "--timeout" && has_value) options.timeout_seconds = std::max(0.001, std::atof(argv[++i]));
+        else if (arg == "--csv" && has_value) options.csv_path = argv[++i];
+        else if (arg == "--json" && has_value) options.json_path = argv[++i];
+        else if (arg == "--baseline" && has_value) options.baseline_path = argv[++i];
+        else if (arg == "--threshold" && has_value) options.threshold_percent = std::atof(argv[++i]);
+        else if (arg == "--noise-floor" && has_value) options.noise_floor_ms = std::atof(argv[++i]);
+        else if (arg.size() > 1 && arg[0] == '-') {
+            std::cerr << "Error: Unknown option " << arg << "\n";
+            print_usage();
+            return 1;
+        } else options.inputs.push_back(arg);
+    }
+    if (options.inputs.empty()) {
+        print_usage();
+        return 1;
+    }
+    if (options.bin_dir.empty()) options.bin_dir = fs::path(argv[0]).parent_path().string();
+    if (options.bin_dir.empty()) options.bin_dir = ".";
+
+    std::vector<Engine> engines;
+    std::string error;
+    if (!select_engines(options.engine_names, engines, error)) {
+        std::cerr << "Error: " << error << "\n";
+        return 1;
+    }
+
+    std::vector<Instance> instances = collect_instances(options.inputs);
+    if (instances.empty()) {
+        std::cerr << "Error: no .cnf files found\n";
+        return 1;
+    }
+
+    std::map<std::pair<std::string, std::string>, std::pair<std::string, double>> baseline;
+    if (!options.baseline_path.empty() && !read_baseline(options.baseline_path, baseline)) {
+        std::cerr << "Error: Could not open baseline " << options.baseline_path << "\n";
+        return 1;
+    }
+
+    std::cout << std::left << std::setw(11) << "engine" << std::setw(40) << "instance" << std::right
+              << std::setw(8) << "result" << std::setw(12) << "median ms" << std::setw(10) << "stddev"
+              << std::setw(10) << "parse ms" << std::setw(10) << "rss KB" << std::setw(12) << "conflicts"
+              << "  note\n";
+
+    std::vector<Measurement> measurements;
+    int regressions = 0;
+    int wrong = 0;
+    int failed = 0;
+    int inconsistent = 0;
+    for (const Engine& engine : engines) {
+        std::string binary = (fs::path(options.bin_dir) / engine.binary).string();
+        if (access(binary.c_str(), X_OK) != 0) {
+            std::cerr << "c skipping " << engine.name << ": " << binary << " not found\n";
+            continue;
+        }
+        for (const Instance& instance : instances) {
+            Measurement m = measure(engine, binary, instance, options);
+            measurements.push_back(m);
+
+            std::string note;
+            auto add_note = [&note](const std::string& text) { note += (note.empty() ? "" : "; ") + text; };
+            if (wrong_answer(m)) {
+                add_note("WRONG, expected " + m.expected);
+                wrong++;
+            }
+            // A crash or a non-zero exit status.
+            if (m.result == "ERROR") {
+                add_note("FAILED");
+                failed++;
+            }
+            if (m.inconsistent) {
+                add_note("INCONSISTENT: both SAT and UNSAT across runs");
+                inconsistent++;
+            }
+            auto base = baseline.find({m.engine, m.instance});
+            if (base != baseline.end()) {
+                const std::string& base_result = base->second.first;
+                double base_ms = base->second.second;
+                bool was_solved = base_result == "SAT" || base_result == "UNSAT";
+                bool is_solved = m.result == "SAT" || m.result == "UNSAT";
+                std::ostringstream change;
+                if (was_solved && !is_solved) {
+                    change << "REGRESSION: " << base_result << " in the baseline";
+                    regressions++;
+                } else if (was_solved && base_ms >= options.noise_floor_ms) {
+                    double percent = 100.0 * (m.solve_median - base_ms) / base_ms;
+                    change << std::showpos << std::fixed << std::setprecision(1) << percent << "%";
+                    if (percent > options.threshold_percent) {
+                        change.str("");
+                        change << "REGRESSION: " << std::showpos << std::fixed << std::setprecision(1) << percent
+                               << "% vs " << std::noshowpos << std::setprecision(3) << base_ms << " ms";
+                        regressions++;
+                    }
+                }
+                if (!change.str().empty()) add_note(change.str());
+            }
+
+            std::cout << std::left << std::setw(11) << m.engine << std::setw(40) << m.instance << std::right
+                      << std::setw(8) << m.result << std::fixed << std::setprecision(3) << std::setw(12)
+                      << m.solve_median << std::setw(10) << m.solve_stddev << std::setw(10) << m.parse_ms
+                      << std::setw(10) << m.peak_rss_kb << std::setw(12) << m.conflicts << "  " << note << "\n";
+        }
+    }
+
+    if (!options.csv_path.empty()) {
+        std::ofstream out(options.csv_path);
+        if (!out.is_open()) {
+            std::cerr << "Error: Could not open file " << options.csv_path << "\n";
+            return 1;
+        }
+        write_csv(out, measurements);
+    }
+    if (!options.json_path.empty()) {
+        std::ofstream out(options.json_path);
+        if (!out.is_open()) {
+            std::cerr << "Error: Could not open file " << options.json_path << "\n";
+            return 1;
+        }
+        write_json(out, measurements);
+    }
+
+    std::cout << std::defaultfloat << "c " << measurements.size() << " measurements, " << wrong << " wrong answers, "
+              << failed << " failed, " << inconsistent << " inconsistent";
+    if (!baseline.empty()) std::cout << ", " << regressions << " regressions over " << options.threshold_percent << "%";
+    std::cout << "\n";
+    return (wrong > 0 || failed > 0 || inconsistent > 0 || regressions > 0) ? 2 : 0;
+}
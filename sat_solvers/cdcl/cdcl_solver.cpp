@@ -0,0 +1,1268 @@
+#include "cdcl_solver.h"
+#include "drat_writer.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+ClauseRef ClauseArena::allocate(const int* clause_literals, size_t size, bool learnt) {
+    if (size > max_words - header_words - memory.size()) return no_clause;
+    ClauseRef ref = (ClauseRef)memory.size();
+    memory.push_back((uint32_t)size);
+    memory.push_back(learnt ? learnt_bit : 0);
+    memory.push_back(0);
+    for (size_t i = 0; i < size; i++) memory.push_back((uint32_t)clause_literals[i]);
+    return ref;
+}
+
+void ClauseArena::free_clause(ClauseRef ref) {
+    memory[ref + 1] |= deleted_bit;
+    wasted_words += header_words + size(ref);
+}
+
+// Copies the clause into the compacted arena the first time it is reached
+// and leaves a forwarding offset behind for every later reference.
+void ClauseArena::relocate(ClauseRef& ref, ClauseArena& to) {
+    if (memory[ref + 1] & relocated_bit) {
+        ref = memory[ref + 2];
+        return;
+    }
+    ClauseRef new_ref = (ClauseRef)to.memory.size();
+    to.memory.insert(to.memory.end(), memory.begin() + ref, memory.begin() + ref + header_words + size(ref));
+    memory[ref + 1] |= relocated_bit;
+    memory[ref + 2] = new_ref;
+    ref = new_ref;
+}
+
+// Exponential moving average whose smoothing factor starts at 1 and shrinks
+// towards alpha, so early samples are not biased towards the zero start.
+class ExponentialMovingAverage {
+private:
+    double alpha;
+    double value = 0.0;
+    long long samples = 0;
+
+public:
+    explicit ExponentialMovingAverage(double alpha) : alpha(alpha) {}
+
+    void update(double sample) {
+        samples++;
+        double factor = std::max(alpha, 1.0 / samples);
+        value += factor * (sample - value);
+    }
+    double get() const { return value; }
+};
+
+class RestartPolicy {
+public:
+    virtual ~RestartPolicy() = default;
+    virtual void on_conflict(int lbd) = 0;
+    virtual bool should_restart() const = 0;
+    virtual void on_restart() = 0;
+};
+
+class NoRestartPolicy : public RestartPolicy {
+public:
+    void on_conflict(int) override {}
+    bool should_restart() const override { return false; }
+    void on_restart() override {}
+};
+
+// Restarts after unit * luby(k) conflicts, where luby(k) is
+// 1, 1, 2, 1, 1, 2, 4, 1, 1, 2, 1, 1, 2, 4, 8, ...
+class LubyRestartPolicy : public RestartPolicy {
+private:
+    int unit;
+    long long restart_index = 1;
+    long long conflicts_since_restart = 0;
+    long long limit;
+
+    static long long luby(long long index);
+
+public:
+    explicit LubyRestartPolicy(int unit) : unit(unit), limit(unit * luby(1)) {}
+
+    void on_conflict(int) override { conflicts_since_restart++; }
+    bool should_restart() const override { return conflicts_since_restart >= limit; }
+    void on_restart() override {
+        conflicts_since_restart = 0;
+        limit = unit * luby(++restart_index);
+    }
+};
+
+long long LubyRestartPolicy::luby(long long index) {
+    long long size = 1;
+    while (size < index + 1) size = 2 * size + 1;
+    while (size - 1 != index) {
+        size = (size - 1) / 2;
+        if (index >= size) index -= size;
+    }
+    return (size + 1) / 2;
+}
+
+// Glucose-style policy: restart when the recent learnt clauses are of
+// noticeably worse quality (higher LBD) than the long-run average.
+class GlucoseRestartPolicy : public RestartPolicy {
+private:
+    ExponentialMovingAverage fast_lbd;
+    ExponentialMovingAverage slow_lbd;
+    double margin;
+    int min_conflicts;
+    long long conflicts_since_restart = 0;
+
+public:
+    GlucoseRestartPolicy(double fast_alpha, double slow_alpha, double margin, int min_conflicts)
+        : fast_lbd(fast_alpha), slow_lbd(slow_alpha), margin(margin), min_conflicts(min_conflicts) {}
+
+    void on_conflict(int lbd) override {
+        conflicts_since_restart++;
+        fast_lbd.update(lbd);
+        slow_lbd.update(lbd);
+    }
+    bool should_restart() const override {
+        return conflicts_since_restart >= min_conflicts && fast_lbd.get() > margin * slow_lbd.get();
+    }
+    void on_restart() override { conflicts_since_restart = 0; }
+};
+
+std::unique_ptr<RestartPolicy> make_restart_policy(const SolverOptions& options) {
+    switch (options.restart_strategy) {
+        case RestartStrategy::luby:
+            return std::make_unique<LubyRestartPolicy>(options.luby_unit);
+        case RestartStrategy::glucose:
+            return std::make_unique<GlucoseRestartPolicy>(options.restart_fast_alpha, options.restart_slow_alpha,
+                                                          options.restart_margin, options.restart_min_conflicts);
+        case RestartStrategy::none:
+            break;
+    }
+    return std::make_unique<NoRestartPolicy>();
+}
+
+void VariableOrderHeap::reset(int variable_count) {
+    heap.clear();
+    position.assign(variable_count, -1);
+    for (int i = 0; i < variable_count; i++) insert(i);
+}
+
+void VariableOrderHeap::grow(int variable_count) {
+    int first = (int)position.size();
+    position.resize(variable_count, -1);
+    for (int i = first; i < variable_count; i++) insert(i);
+}
+
+void VariableOrderHeap::insert(int variable) {
+    if (contains(variable)) return;
+    position[variable] = (int)heap.size();
+    heap.push_back(variable);
+    sift_up(position[variable]);
+}
+
+int VariableOrderHeap::pop() {
+    int top = heap[0];
+    heap[0] = heap.back();
+    position[heap[0]] = 0;
+    position[top] = -1;
+    heap.pop_back();
+    if (heap.size() > 1) sift_down(0);
+    return top;
+}
+
+void VariableOrderHeap::sift_up(int i) {
+    int variable = heap[i];
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (!before(variable, heap[parent])) break;
+        heap[i] = heap[parent];
+        position[heap[i]] = i;
+        i = parent;
+    }
+    heap[i] = variable;
+    position[variable] = i;
+}
+
+void VariableOrderHeap::sift_down(int i) {
+    int variable = heap[i];
+    int size = (int)heap.size();
+    while (2 * i + 1 < size) {
+        int child = 2 * i + 1;
+        if (child + 1 < size && before(heap[child + 1], heap[child])) child++;
+        if (!before(heap[child], variable)) break;
+        heap[i] = heap[child];
+        position[heap[i]] = i;
+        i = child;
+    }
+    heap[i] = variable;
+    position[variable] = i;
+}
+
+void ClauseExchange::publish(int producer, const int* clause, int size, int lbd) {
+    uint64_t position = write_position.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = slots[position & (capacity - 1)];
+
+    // Give up rather than wait if another producer is writing this slot or
+    // has already reused it for a later position.
+    uint64_t writing = 2 * position + 1;
+    uint64_t current = slot.sequence.load(std::memory_order_acquire);
+    if ((current & 1) || current >= writing) return;
+    if (!slot.sequence.compare_exchange_strong(current, writing, std::memory_order_acq_rel)) return;
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.producer.store(producer, std::memory_order_relaxed);
+    slot.size.store(size, std::memory_order_relaxed);
+    slot.lbd.store(lbd, std::memory_order_relaxed);
+    for (int i = 0; i < size; i++) slot.literals[i].store(clause[i], std::memory_order_relaxed);
+    slot.sequence.store(writing + 1, std::memory_order_release);
+}
+
+bool ClauseExchange::fetch(int consumer, uint64_t& read_position, std::vector<int>& clause, int& lbd) {
+    uint64_t end = write_position.load(std::memory_order_acquire);
+    if (end - read_position > capacity) read_position = end - capacity;
+
+    while (read_position < end) {
+        uint64_t position = read_position++;
+        Slot& slot = slots[position & (capacity - 1)];
+
+        uint64_t published = 2 * position + 2;
+        if (slot.sequence.load(std::memory_order_acquire) != published) continue;
+        if (slot.producer.load(std::memory_order_relaxed) == consumer) continue;
+
+        int size = slot.size.load(std::memory_order_relaxed);
+        lbd = slot.lbd.load(std::memory_order_relaxed);
+        clause.resize(size);
+        for (int i = 0; i < size; i++) clause[i] = slot.literals[i].load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != published) continue;
+        return true;
+    }
+    return false;
+}
+
+SATSolverCDCL::SATSolverCDCL() : generator(random_generator()), order_heap(activity) {
+    reset();
+}
+
+SATSolverCDCL::SATSolverCDCL(const SolverOptions& options)
+    : generator(random_generator()), options(options), order_heap(activity) {
+    if (options.seed != 0) generator.seed(options.seed);
+    reset();
+}
+
+SATSolverCDCL::~SATSolverCDCL() = default;
+
+void SATSolverCDCL::reset() {
+    already_unsatisfied = false;
+    literal_count = 0;
+    clause_count = 0;
+    assigned_literal_count = 0;
+    kappa_antecedent = no_clause;
+    kappa_literal = 0;
+    pick_counter = 0;
+
+    literals.clear();
+    literal_frequency.clear();
+    literal_polarity.clear();
+    original_literal_frequency.clear();
+    clause_arena.clear();
+    original_clauses.clear();
+    learnt_clauses.clear();
+    literal_antecedent.clear();
+    literal_decision_level.clear();
+    // Watch lists keep their capacity for the next formula.
+    for (std::vector<Watcher>& watch_list : watches) watch_list.clear();
+    trail.clear();
+    trail_limits.clear();
+    seen.clear();
+    activity.clear();
+    activity_increment = 1.0;
+    order_heap.reset(0);
+    saved_phase.clear();
+    level_stamp.assign(1, 0);
+    current_stamp = 0;
+    restart_policy = make_restart_policy(options);
+    stats = SolverStats();
+    stats.times.enabled = options.time_phases;
+    budget.start(options.limits);
+    unit_clauses.clear();
+    propagation_head = 0;
+    clause_activity_increment = 1.0f;
+    next_reduction = options.reduce_interval;
+    reduction_count = 0;
+    model_values.clear();
+    failed_assumption_literals.clear();
+}
+
+// Grows every per-variable array so that variables 1..count exist. New
+// variables start unassigned, with no saved phase, and enter the order heap.
+void SATSolverCDCL::reserve_variables(int count) {
+    if (count <= literal_count) return;
+
+    literals.resize(count, -1);
+    literal_frequency.resize(count, 0);
+    literal_polarity.resize(count, 0);
+    original_literal_frequency.resize(count, 0);
+    literal_antecedent.resize(count, no_clause);
+    literal_decision_level.resize(count, -1);
+    if (watches.size() < 2 * (size_t)count) watches.resize(2 * (size_t)count);
+    seen.resize(count, 0);
+    saved_phase.resize(count, -1);
+    if (level_stamp.size() < (size_t)count + 1) level_stamp.resize((size_t)count + 1, 0);
+    activity.resize(count, 0.0);
+    if (options.randomize_activity) {
+        std::uniform_real_distribution<double> jitter(0.0, 1e-5);
+        for (int i = literal_count; i < count; i++) activity[i] = jitter(generator);
+    }
+    trail.reserve(count);
+    literal_count = count;
+    order_heap.grow(count);
+}
+
+void SATSolverCDCL::initialize(const DimacsFormula& formula) {
+    reset();
+    load_stats = formula.load_stats;
+    reserve_variables(formula.variable_count);
+    clause_arena.reserve(formula.clause_count() * ClauseArena::header_words + formula.literals.size());
+
+    for (size_t i = 0; i < formula.clause_count(); ++i) {
+        add_clause(formula.clause_begin(i), formula.clause_size(i));
+    }
+}
+
+bool SATSolverCDCL::add_clause(const int* clause_literals, size_t size) {
+    backtrack(0);
+    if (already_unsatisfied) return false;
+
+    std::vector<int>& clause = added_clause;
+    clause.assign(clause_literals, clause_literals + size);
+    int highest_variable = 0;
+    for (int literal : clause) highest_variable = std::max(highest_variable, std::abs(literal));
+    reserve_variables(highest_variable);
+
+    for (int literal : clause) {
+        int lit_idx = literal_to_variable_index(literal);
+        original_literal_frequency[lit_idx]++;
+        if (literal_frequency[lit_idx] != -1) literal_frequency[lit_idx]++;
+        if (literal > 0) literal_polarity[lit_idx]++;
+        else literal_polarity[lit_idx]--;
+    }
+
+    // Two watches on the same variable would never fire correctly, so drop
+    // repeated literals and tautologies up front.
+    if (normalize_clause(clause)) return true;
+
+    // Assignments left from earlier solve calls are final at the root: drop
+    // false literals so both watches start on unassigned ones.
+    size_t kept = 0;
+    for (int literal : clause) {
+        int value = literal_value(literal);
+        if (value == 1) return true;
+        if (value == -1) clause[kept++] = literal;
+    }
+    if (proof && kept < clause.size()) proof->add(clause.data(), kept);
+    clause.resize(kept);
+    if (clause.empty()) {
+        already_unsatisfied = true;
+        return false;
+    }
+
+    ClauseRef clause_ref = clause_arena.allocate(clause.data(), clause.size(), false);
+    if (clause_ref == no_clause) {
+        // The formula does not fit; solve() answers UNKNOWN.
+        budget.stop(BudgetLimit::clause_arena);
+        return true;
+    }
+    original_clauses.push_back(clause_ref);
+    clause_count++;
+    if (clause.size() == 1) {
+        unit_clauses.push_back(clause_ref);
+    } else {
+        attach_clause(clause_ref);
+    }
+    return true;
+}
+
+void SATSolverCDCL::attach_clause(ClauseRef clause_ref) {
+    const int* clause = clause_arena.literals(clause_ref);
+    ClauseRef watched = (clause_arena.size(clause_ref) == 2) ? binary_watch : clause_ref;
+    watches[literal_to_watch_index(clause[0])].push_back({watched, clause[1]});
+    watches[literal_to_watch_index(clause[1])].push_back({watched, clause[0]});
+}
+
+int SATSolverCDCL::unit_propagate(int decision_level) {
+    SAT_PHASE(stats.times, phase_propagate);
+    while (propagation_head < trail.size()) {
+        int false_literal = -trail[propagation_head++];
+        SAT_INSTRUMENT(stats.propagations++);
+        std::vector<Watcher>& watch_list = watches[literal_to_watch_index(false_literal)];
+
+        size_t i = 0;
+        size_t j = 0;
+        while (i < watch_list.size()) {
+            Watcher watcher = watch_list[i++];
+            int blocker_value = literal_value(watcher.blocker);
+            if (blocker_value == 1) {
+                watch_list[j++] = watcher;
+                continue;
+            }
+
+            // A binary clause is decided by its other literal alone.
+            if (watcher.binary()) {
+                SAT_INSTRUMENT(stats.binary_visits++);
+                watch_list[j++] = watcher;
+                if (blocker_value == 0) {
+                    while (i < watch_list.size()) watch_list[j++] = watch_list[i++];
+                    watch_list.resize(j);
+                    kappa_antecedent = binary_reason(false_literal);
+                    kappa_literal = watcher.blocker;
+                    return RetVal::r_unsatisfied;
+                }
+                assign_literal(watcher.blocker, decision_level, binary_reason(false_literal));
+                continue;
+            }
+
+            SAT_INSTRUMENT(stats.clause_visits++);
+            int* clause = clause_arena.literals(watcher.clause_ref);
+            uint32_t clause_size = clause_arena.size(watcher.clause_ref);
+            if (clause[0] == false_literal) std::swap(clause[0], clause[1]);
+
+            int first_literal = clause[0];
+            if (first_literal != watcher.blocker && literal_value(first_literal) == 1) {
+                watch_list[j++] = {watcher.clause_ref, first_literal};
+                continue;
+            }
+
+            bool new_watch_found = false;
+            for (uint32_t k = 2; k < clause_size; k++) {
+                if (literal_value(clause[k]) != 0) {
+                    clause[1] = clause[k];
+                    clause[k] = false_literal;
+                    watches[literal_to_watch_index(clause[1])].push_back({watcher.clause_ref, first_literal});
+                    new_watch_found = true;
+                    break;
+                }
+            }
+            if (new_watch_found) continue;
+
+            watch_list[j++] = {watcher.clause_ref, first_literal};
+            if (literal_value(first_literal) == 0) {
+                while (i < watch_list.size()) watch_list[j++] = watch_list[i++];
+                watch_list.resize(j);
+                kappa_antecedent = watcher.clause_ref;
+                return RetVal::r_unsatisfied;
+            }
+            assign_literal(first_literal, decision_level, watcher.clause_ref);
+        }
+        watch_list.resize(j);
+    }
+
+    kappa_antecedent = no_clause;
+    return RetVal::r_normal;
+}
+
+void SATSolverCDCL::assign_literal(int variable, int decision_level, ClauseRef antecedent) {
+    int literal_index = literal_to_variable_index(variable);
+    int value = (variable > 0) ? 1 : 0;
+    
+    literals[literal_index] = value;
+    literal_decision_level[literal_index] = decision_level;
+    literal_antecedent[literal_index] = antecedent;
+    
+    literal_frequency[literal_index] = -1; 
+    assigned_literal_count++;
+    trail.push_back(variable);
+}
+
+void SATSolverCDCL::unassign_literal(int literal_index) {
+    if (options.phase_saving) saved_phase[literal_index] = literals[literal_index];
+    literals[literal_index] = -1;
+    literal_decision_level[literal_index] = -1;
+    literal_antecedent[literal_index] = no_clause;
+    literal_frequency[literal_index] = original_literal_frequency[literal_index];
+    assigned_literal_count--;
+    if (options.branching_heuristic == BranchingHeuristic::vsids) order_heap.insert(literal_index);
+}
+
+int SATSolverCDCL::literal_to_variable_index(int variable) {
+    return (variable > 0) ? variable - 1 : -variable - 1;
+}
+
+int SATSolverCDCL::literal_to_watch_index(int variable) {
+    return (variable > 0) ? 2 * (variable - 1) : 2 * (-variable - 1) + 1;
+}
+
+int SATSolverCDCL::literal_value(int variable) {
+    int value = literals[literal_to_variable_index(variable)];
+    if (value == -1) return -1;
+    return (variable > 0) ? value : 1 - value;
+}
+
+// The reason of a literal implied by a binary clause with other_literal.
+ClauseRef SATSolverCDCL::binary_reason(int other_literal) {
+    return binary_reason_tag | (ClauseRef)literal_to_watch_index(other_literal);
+}
+
+int SATSolverCDCL::binary_reason_literal(ClauseRef reason) {
+    int watch_index = (int)(reason & ~binary_reason_tag);
+    int variable = watch_index / 2 + 1;
+    return (watch_index & 1) ? -variable : variable;
+}
+
+int SATSolverCDCL::conflict_analysis_and_backtrack(int decision_level) {
+    SAT_PHASE(stats.times, phase_analyze);
+    // First-UIP analysis: walk the trail backwards, resolving away every
+    // marked literal of the conflict level until only one remains. Literals
+    // from lower levels go straight into the learnt clause; level 0 literals
+    // are permanently false and are dropped.
+    learnt_clause.clear();
+    learnt_clause.push_back(0);
+
+    int path_count = 0;
+    int resolved_literal = 0;
+    ClauseRef clause_ref = kappa_antecedent;
+    int trail_index = (int)trail.size() - 1;
+    // A binary reason is rebuilt from the literal it implied (or, for the
+    // conflict, kappa_literal) and the other literal it stores.
+    int binary_clause[2];
+    int implied_literal = kappa_literal;
+
+    do {
+        const int* clause;
+        uint32_t clause_size;
+        if (is_binary_reason(clause_ref)) {
+            binary_clause[0] = implied_literal;
+            binary_clause[1] = binary_reason_literal(clause_ref);
+            clause = binary_clause;
+            clause_size = 2;
+        } else {
+            if (clause_arena.learnt(clause_ref)) bump_clause(clause_ref);
+            clause = clause_arena.literals(clause_ref);
+            clause_size = clause_arena.size(clause_ref);
+        }
+        for (uint32_t k = 0; k < clause_size; k++) {
+            int variable = clause[k];
+            if (variable == resolved_literal) continue;
+            int lit_idx = literal_to_variable_index(variable);
+            if (seen[lit_idx] || literal_decision_level[lit_idx] == 0) continue;
+
+            seen[lit_idx] = 1;
+            bump_variable_activity(lit_idx);
+            if (literal_decision_level[lit_idx] == decision_level) {
+                path_count++;
+            } else {
+                learnt_clause.push_back(variable);
+            }
+        }
+
+        while (!seen[literal_to_variable_index(trail[trail_index])]) trail_index--;
+        resolved_literal = trail[trail_index--];
+        implied_literal = resolved_literal;
+        int resolved_idx = literal_to_variable_index(resolved_literal);
+        clause_ref = literal_antecedent[resolved_idx];
+        seen[resolved_idx] = 0;
+        path_count--;
+    } while (path_count > 0);
+
+    learnt_clause[0] = -resolved_literal;
+
+    // Every literal after the first is still marked seen.
+    minimize_marked.clear();
+    for (size_t i = 1; i < learnt_clause.size(); i++) {
+        minimize_marked.push_back(literal_to_variable_index(learnt_clause[i]));
+    }
+    if (options.minimize_learnt) minimize_learnt_clause();
+    for (int lit_idx : minimize_marked) seen[lit_idx] = 0;
+
+    int backtracked_decision_level = 0;
+    int deepest_position = 0;
+    for (size_t i = 1; i < learnt_clause.size(); i++) {
+        int lit_idx = literal_to_variable_index(learnt_clause[i]);
+        if (literal_decision_level[lit_idx] > backtracked_decision_level) {
+            backtracked_decision_level = literal_decision_level[lit_idx];
+            deepest_position = (int)i;
+        }
+    }
+    // The deepest remaining literal becomes the second watch, so the clause
+    // stays correctly watched after backtracking.
+    if (deepest_position > 0) std::swap(learnt_clause[1], learnt_clause[deepest_position]);
+
+    for (int variable : learnt_clause) {
+        int lit_idx = literal_to_variable_index(variable);
+        int update = (variable > 0) ? 1 : -1;
+        literal_polarity[lit_idx] += update;
+        
+        if (literal_frequency[lit_idx] != -1) {
+            literal_frequency[lit_idx]++;
+        }
+        original_literal_frequency[lit_idx]++;
+    }
+
+    stats.conflicts++;
+    int lbd = compute_lbd(learnt_clause.data(), learnt_clause.size());
+    restart_policy->on_conflict(lbd);
+    decay_variable_activities();
+    clause_activity_increment /= 0.999f;
+    backtrack(backtracked_decision_level);
+
+    ClauseRef learnt_clause_ref = store_learnt_clause(learnt_clause, lbd);
+    // Nothing is asserted without a stored reason; the search loop sees the
+    // budget hit and answers UNKNOWN.
+    if (learnt_clause_ref == no_clause) return backtracked_decision_level;
+    if (proof) proof->add(learnt_clause.data(), learnt_clause.size());
+    SAT_INSTRUMENT(stats.learnt_literals += (long long)learnt_clause.size());
+    if (clause_exchange && lbd <= options.share_max_lbd &&
+        (int)learnt_clause.size() <= ClauseExchange::max_clause_size) {
+        clause_exchange->publish(worker_id, learnt_clause.data(), (int)learnt_clause.size(), lbd);
+        stats.exported_clauses++;
+    }
+    if (learnt_clause.size() > 1) attach_clause(learnt_clause_ref);
+    ClauseRef reason = (learnt_clause.size() == 2) ? binary_reason(learnt_clause[1]) : learnt_clause_ref;
+    assign_literal(learnt_clause[0], backtracked_decision_level, reason);
+
+    return backtracked_decision_level;
+}
+
+// The literals of a reason other than the one it implied are at positions
+// 1 .. reason_size - 1: arena reasons keep the implied literal first, and a
+// binary reason holds just the other literal.
+uint32_t SATSolverCDCL::reason_size(ClauseRef reason) {
+    return is_binary_reason(reason) ? 2 : clause_arena.size(reason);
+}
+
+int SATSolverCDCL::reason_literal(ClauseRef reason, uint32_t index) {
+    return is_binary_reason(reason) ? binary_reason_literal(reason) : clause_arena.literals(reason)[index];
+}
+
+// Seen marks during minimization. Analysis leaves the learnt clause's
+// literals marked as sources; the walk below memoizes every variable it
+// settles as removable or, once it has failed, as poisoned.
+enum SeenMark : char {
+    seen_none = 0,
+    seen_source = 1,
+    seen_removable = 2,
+    seen_failed = 3
+};
+
+// True if literal, a false literal of the learnt clause, is implied by the
+// other literals: every path back through the reasons ends at level 0 or
+// at a source. The walk is depth-first over an explicit stack. A decision,
+// or a literal on a level no source is on (abstract_levels holds one bit
+// per level, modulo 32), cannot be removed, and poisons the whole path.
+bool SATSolverCDCL::literal_redundant(int literal, uint32_t abstract_levels) {
+    minimize_stack.clear();
+    ClauseRef reason = literal_antecedent[literal_to_variable_index(literal)];
+
+    for (uint32_t i = 1;; i++) {
+        if (i < reason_size(reason)) {
+            int parent = reason_literal(reason, i);
+            int parent_idx = literal_to_variable_index(parent);
+            char mark = seen[parent_idx];
+            if (literal_decision_level[parent_idx] == 0 || mark == seen_source || mark == seen_removable) continue;
+
+            ClauseRef parent_reason = literal_antecedent[parent_idx];
+            if (parent_reason == no_clause || mark == seen_failed ||
+                !(abstract_levels & (1u << (literal_decision_level[parent_idx] & 31)))) {
+                minimize_stack.push_back({0, literal});
+                for (const MinimizeFrame& frame : minimize_stack) {
+                    int frame_idx = literal_to_variable_index(frame.literal);
+                    if (seen[frame_idx] == seen_none) {
+                        seen[frame_idx] = seen_failed;
+                        minimize_marked.push_back(frame_idx);
+                    }
+                }
+                return false;
+            }
+
+            minimize_stack.push_back({i, literal});
+            i = 0;
+            literal = parent;
+            reason = parent_reason;
+        } else {
+            int lit_idx = literal_to_variable_index(literal);
+            if (seen[lit_idx] == seen_none) {
+                seen[lit_idx] = seen_removable;
+                minimize_marked.push_back(lit_idx);
+            }
+            if (minimize_stack.empty()) return true;
+
+            i = minimize_stack.back().index;
+            literal = minimize_stack.back().literal;
+            reason = literal_antecedent[literal_to_variable_index(literal)];
+            minimize_stack.pop_back();
+        }
+    }
+}
+
+// MiniSat-style recursive minimization of learnt_clause. The literals are
+// false, so the walk starts from their negations' reasons.
+void SATSolverCDCL::minimize_learnt_clause() {
+    uint32_t abstract_levels = 0;
+    for (size_t i = 1; i < learnt_clause.size(); i++) {
+        abstract_levels |= 1u << (literal_decision_level[literal_to_variable_index(learnt_clause[i])] & 31);
+    }
+
+    size_t kept = 1;
+    for (size_t i = 1; i < learnt_clause.size(); i++) {
+        int literal = learnt_clause[i];
+        if (literal_antecedent[literal_to_variable_index(literal)] == no_clause ||
+            !literal_redundant(-literal, abstract_levels)) {
+            learnt_clause[kept++] = literal;
+        }
+    }
+    SAT_INSTRUMENT(stats.minimized_literals += (long long)(learnt_clause.size() - kept));
+    learnt_clause.resize(kept);
+}
+
+// Assumptions and cube literals that are already implied open empty levels,
+// so the level count is not bounded by the variable count and level_stamp
+// grows with it.
+void SATSolverCDCL::new_decision_level() {
+    trail_limits.push_back((int)trail.size());
+    if (trail_limits.size() >= level_stamp.size()) level_stamp.resize(trail_limits.size() + 1, 0);
+}
+
+// Literal block distance: the number of distinct decision levels in the clause.
+int SATSolverCDCL::compute_lbd(const int* clause, size_t size) {
+    current_stamp++;
+    int lbd = 0;
+    for (size_t i = 0; i < size; i++) {
+        int level = literal_decision_level[literal_to_variable_index(clause[i])];
+        if (level_stamp[level] != current_stamp) {
+            level_stamp[level] = current_stamp;
+            lbd++;
+        }
+    }
+    return lbd;
+}
+
+ClauseTier SATSolverCDCL::tier_for_lbd(int lbd) {
+    if (lbd <= options.core_lbd) return ClauseTier::core;
+    if (lbd <= options.tier2_lbd) return ClauseTier::tier2;
+    return ClauseTier::local;
+}
+
+ClauseRef SATSolverCDCL::store_learnt_clause(const std::vector<int>& clause, int lbd) {
+    ClauseRef clause_ref = clause_arena.allocate(clause.data(), clause.size(), true);
+    if (clause_ref == no_clause) {
+        budget.stop(BudgetLimit::clause_arena);
+        return no_clause;
+    }
+    clause_arena.set_tier(clause_ref, tier_for_lbd(lbd));
+    clause_arena.set_lbd(clause_ref, lbd);
+    clause_arena.set_activity(clause_ref, clause_activity_increment);
+    learnt_clauses.push_back(clause_ref);
+    clause_count++;
+    return clause_ref;
+}
+
+// Called for every learnt clause that takes part in conflict analysis. The
+// clause's LBD is recomputed and it is promoted if it got better. Tier 2
+// clauses get two reductions of grace, local clauses one.
+void SATSolverCDCL::bump_clause(ClauseRef clause_ref) {
+    float activity_value = clause_arena.activity(clause_ref) + clause_activity_increment;
+    clause_arena.set_activity(clause_ref, activity_value);
+    if (activity_value > 1e20f) {
+        for (ClauseRef learnt_ref : learnt_clauses) {
+            clause_arena.set_activity(learnt_ref, clause_arena.activity(learnt_ref) * 1e-20f);
+        }
+        clause_activity_increment *= 1e-20f;
+    }
+
+    ClauseTier tier = clause_arena.tier(clause_ref);
+    if (tier == ClauseTier::core) return;
+
+    int lbd = compute_lbd(clause_arena.literals(clause_ref), clause_arena.size(clause_ref));
+    if (lbd < clause_arena.lbd(clause_ref)) {
+        clause_arena.set_lbd(clause_ref, lbd);
+        ClauseTier new_tier = tier_for_lbd(lbd);
+        if (new_tier < tier) {
+            clause_arena.set_tier(clause_ref, new_tier);
+            tier = new_tier;
+        }
+    }
+    clause_arena.set_used(clause_ref, tier == ClauseTier::tier2 ? 2 : 1);
+}
+
+// A clause that is the reason of a current assignment must survive: conflict
+// analysis may still resolve on it. Reasons always have the implied literal
+// in position 0.
+bool SATSolverCDCL::clause_locked(ClauseRef clause_ref) {
+    int first_literal = clause_arena.literals(clause_ref)[0];
+    return literal_value(first_literal) == 1 &&
+           literal_antecedent[literal_to_variable_index(first_literal)] == clause_ref;
+}
+
+void SATSolverCDCL::reduce_learnt_clauses() {
+    std::vector<ClauseRef> candidates;
+    for (ClauseRef clause_ref : learnt_clauses) {
+        ClauseTier tier = clause_arena.tier(clause_ref);
+        if (tier == ClauseTier::core) continue;
+
+        int used = clause_arena.used(clause_ref);
+        if (used > 0) {
+            clause_arena.set_used(clause_ref, used - 1);
+            continue;
+        }
+        if (tier == ClauseTier::tier2) {
+            clause_arena.set_tier(clause_ref, ClauseTier::local);
+            continue;
+        }
+        if (clause_arena.size(clause_ref) > 2 && !clause_locked(clause_ref)) candidates.push_back(clause_ref);
+    }
+
+    // Delete the worse half of the unprotected local clauses: highest LBD
+    // first, lowest activity among equal LBD.
+    std::sort(candidates.begin(), candidates.end(), [this](ClauseRef a, ClauseRef b) {
+        if (clause_arena.lbd(a) != clause_arena.lbd(b)) return clause_arena.lbd(a) > clause_arena.lbd(b);
+        return clause_arena.activity(a) < clause_arena.activity(b);
+    });
+    candidates.resize(candidates.size() / 2);
+    if (candidates.empty()) return;
+
+    for (ClauseRef clause_ref : candidates) {
+        if (proof) proof->remove(clause_arena.literals(clause_ref), clause_arena.size(clause_ref));
+        clause_arena.free_clause(clause_ref);
+    }
+    for (std::vector<Watcher>& watch_list : watches) {
+        watch_list.erase(std::remove_if(watch_list.begin(), watch_list.end(), [this](const Watcher& watcher) {
+            return !watcher.binary() && clause_arena.deleted(watcher.clause_ref);
+        }), watch_list.end());
+    }
+    learnt_clauses.erase(std::remove_if(learnt_clauses.begin(), learnt_clauses.end(),
+        [this](ClauseRef clause_ref) { return clause_arena.deleted(clause_ref); }), learnt_clauses.end());
+
+    stats.reductions++;
+    stats.deleted_clauses += (long long)candidates.size();
+    clause_count -= (int)candidates.size();
+
+    if (clause_arena.wasted() > clause_arena.size_in_words() / 5) collect_garbage();
+}
+
+// Compacts the arena by copying every live clause into a fresh buffer and
+// rewriting all references: watches, reasons and the clause lists. Binary
+// watchers and binary reasons hold no reference.
+void SATSolverCDCL::collect_garbage() {
+    ClauseArena compacted;
+    compacted.reserve(clause_arena.size_in_words() - clause_arena.wasted());
+
+    for (std::vector<Watcher>& watch_list : watches) {
+        for (Watcher& watcher : watch_list) {
+            if (!watcher.binary()) clause_arena.relocate(watcher.clause_ref, compacted);
+        }
+    }
+    for (int variable : trail) {
+        ClauseRef& reason = literal_antecedent[literal_to_variable_index(variable)];
+        if (reason != no_clause && !is_binary_reason(reason)) clause_arena.relocate(reason, compacted);
+    }
+    for (ClauseRef& clause_ref : original_clauses) clause_arena.relocate(clause_ref, compacted);
+    for (ClauseRef& clause_ref : unit_clauses) clause_arena.relocate(clause_ref, compacted);
+    for (ClauseRef& clause_ref : learnt_clauses) clause_arena.relocate(clause_ref, compacted);
+
+    clause_arena.swap(compacted);
+    stats.garbage_collections++;
+}
+
+void SATSolverCDCL::backtrack(int decision_level) {
+    if ((int)trail_limits.size() <= decision_level) return;
+
+    int trail_target = trail_limits[decision_level];
+    while ((int)trail.size() > trail_target) {
+        unassign_literal(literal_to_variable_index(trail.back()));
+        trail.pop_back();
+    }
+    trail_limits.resize(decision_level);
+    propagation_head = trail.size();
+}
+
+void SATSolverCDCL::bump_variable_activity(int literal_index) {
+    if (options.branching_heuristic != BranchingHeuristic::vsids) return;
+
+    activity[literal_index] += activity_increment;
+    if (activity[literal_index] > 1e100) {
+        for (double& value : activity) value *= 1e-100;
+        activity_increment *= 1e-100;
+    }
+    order_heap.increased(literal_index);
+}
+
+// EVSIDS: instead of decaying every activity, grow the bump so that older
+// bumps lose weight geometrically.
+void SATSolverCDCL::decay_variable_activities() {
+    if (options.branching_heuristic != BranchingHeuristic::vsids) return;
+    activity_increment /= options.variable_decay;
+}
+
+int SATSolverCDCL::pick_branching_variable() {
+    SAT_PHASE(stats.times, phase_decide);
+    if (options.branching_heuristic == BranchingHeuristic::vsids) return pick_activity_variable();
+    return pick_frequency_variable();
+}
+
+int SATSolverCDCL::pick_activity_variable() {
+    while (!order_heap.empty()) {
+        int idx = order_heap.pop();
+        if (literals[idx] == -1) return choose_polarity(idx);
+    }
+    return pick_frequency_variable();
+}
+
+int SATSolverCDCL::choose_polarity(int literal_index) {
+    bool positive;
+    if (saved_phase[literal_index] != -1) {
+        positive = saved_phase[literal_index] == 1;
+    } else {
+        switch (options.initial_polarity) {
+            case PolarityMode::positive: positive = true; break;
+            case PolarityMode::negative: positive = false; break;
+            case PolarityMode::random: positive = generator() & 1; break;
+            default: positive = literal_polarity[literal_index] >= 0; break;
+        }
+    }
+    return positive ? literal_index + 1 : -literal_index - 1;
+}
+
+int SATSolverCDCL::pick_frequency_variable() {
+    std::uniform_int_distribution<int> choose_branch(1, 10);
+    std::uniform_int_distribution<int> choose_literal(0, literal_count - 1);
+    
+    if (pick_counter > 20 * literal_count) {
+        for (size_t i = 0; i < literals.size(); i++) {
+            original_literal_frequency[i] /= 2;
+            if (literal_frequency[i] != -1) literal_frequency[i] /= 2;
+        }
+        pick_counter = 0;
+    }
+    
+    int variable_idx = -1;
+    int max_freq = -1;
+    
+    for (int i = 0; i < literal_count; i++) {
+        if (literal_frequency[i] > max_freq) {
+            max_freq = literal_frequency[i];
+            variable_idx = i;
+        }
+    }
+    
+    if (variable_idx != -1) {
+        pick_counter++;
+        return choose_polarity(variable_idx);
+    }
+
+    bool too_many_attempts = false;
+    int attempt_counter = 0;
+    do {
+        int idx = choose_literal(generator);
+        if (literal_frequency[idx] != -1) {
+             return choose_polarity(idx);
+        }
+        attempt_counter++;
+        if (attempt_counter > 10 * literal_count) too_many_attempts = true;
+    } while (!too_many_attempts);
+
+    return 1;
+}
+
+bool SATSolverCDCL::all_variables_assigned() {
+    return literal_count == assigned_literal_count;
+}
+
+// Adds the clauses other portfolio workers published since the last call.
+// Only runs at decision level 0, where every assigned literal is final, so
+// each clause can be simplified against the current assignment before it is
+// stored. Returns false if an imported clause proves the formula UNSAT.
+bool SATSolverCDCL::import_shared_clauses() {
+    int lbd = 0;
+    while (clause_exchange->fetch(worker_id, exchange_read_position, imported_clause, lbd)) {
+        bool satisfied = false;
+        size_t kept = 0;
+        for (int variable : imported_clause) {
+            int value = literal_value(variable);
+            if (value == 1) {
+                satisfied = true;
+                break;
+            }
+            if (value == -1) imported_clause[kept++] = variable;
+        }
+        if (satisfied) continue;
+        imported_clause.resize(kept);
+        if (imported_clause.empty()) return false;
+
+        ClauseRef clause_ref = store_learnt_clause(imported_clause, std::min(lbd, (int)kept));
+        if (clause_ref == no_clause) break;
+        stats.imported_clauses++;
+        if (kept == 1) {
+            assign_literal(imported_clause[0], 0, clause_ref);
+        } else {
+            attach_clause(clause_ref);
+        }
+    }
+    return unit_propagate(0) != RetVal::r_unsatisfied;
+}
+
+// Asserts the unit clauses and propagates at decision level 0. Returns
+// false, and remembers it, if the formula is unsatisfiable at the root.
+bool SATSolverCDCL::propagate_root() {
+    backtrack(0);
+    if (already_unsatisfied) return false;
+
+    for (ClauseRef clause_ref : unit_clauses) {
+        int unit_literal = clause_arena.literals(clause_ref)[0];
+        int value = literal_value(unit_literal);
+        if (value == 0) {
+            already_unsatisfied = true;
+            return false;
+        }
+        if (value == -1) assign_literal(unit_literal, 0, clause_ref);
+    }
+
+    if (unit_propagate(0) == RetVal::r_unsatisfied) already_unsatisfied = true;
+    return !already_unsatisfied;
+}
+
+// Searches for a model that also satisfies the current assumptions. Each
+// assumption is decided on its own decision level before any free decision;
+// an assumption that is already false ends the search with r_unsatisfied.
+int SATSolverCDCL::CDCL() {
+    int decision_level = 0;
+    if (!propagate_root()) return RetVal::r_unsatisfied;
+
+    long long conflict_limit = (conflict_budget < 0) ? -1 : stats.conflicts + conflict_budget;
+    int unit_propagate_result;
+
+    while (true) {
+        if (terminate_flag && terminate_flag->load(std::memory_order_relaxed)) return RetVal::r_unknown;
+        if (conflict_limit >= 0 && stats.conflicts >= conflict_limit) return RetVal::r_unknown;
+        if (budget.exhausted(stats.conflicts, stats.decisions, 0)) return RetVal::r_unknown;
+
+        if (decision_level > 0 && restart_policy->should_restart()) {
+            backtrack(0);
+            decision_level = 0;
+            stats.restarts++;
+            restart_policy->on_restart();
+        }
+
+        if (decision_level == 0 && clause_exchange && !import_shared_clauses()) {
+            already_unsatisfied = true;
+            return RetVal::r_unsatisfied;
+        }
+
+        if (options.reduce_interval > 0 && stats.conflicts >= next_reduction) {
+            reduce_learnt_clauses();
+            reduction_count++;
+            next_reduction = stats.conflicts + options.reduce_interval +
+                             (long long)options.reduce_increment * reduction_count;
+        }
+
+        int picked_variable = 0;
+        while (decision_level < (int)assumptions.size()) {
+            int assumption = assumptions[decision_level];
+            int value = literal_value(assumption);
+            if (value == 0) {
+                analyze_final(assumption);
+                return RetVal::r_unsatisfied;
+            }
+            if (value == -1) {
+                picked_variable = assumption;
+                break;
+            }
+            // Already implied: open an empty level to keep levels aligned.
+            new_decision_level();
+            decision_level++;
+        }
+
+        if (picked_variable == 0) {
+            if (all_variables_assigned()) break;
+            picked_variable = pick_branching_variable();
+            stats.decisions++;
+            if (progress.due()) report_progress();
+        }
+        new_decision_level();
+        decision_level++;
+        assign_literal(picked_variable, decision_level, no_clause);
+        
+        while (true) {
+            unit_propagate_result = unit_propagate(decision_level);
+            if (unit_propagate_result == RetVal::r_unsatisfied) {
+                if (decision_level == 0) {
+                    already_unsatisfied = true;
+                    return RetVal::r_unsatisfied;
+                }
+                decision_level = conflict_analysis_and_backtrack(decision_level);
+            } else {
+                break;
+            }
+        }
+    }
+    return RetVal::r_satisfied;
+}
+
+// Called when assumption is found false: walks the implication graph back
+// from it and collects the decisions it depends on. Every decision below the
+// current assumption is itself an assumption.
+void SATSolverCDCL::analyze_final(int assumption) {
+    failed_assumption_literals.assign(1, assumption);
+    int assumption_index = literal_to_variable_index(assumption);
+    if (literal_decision_level[assumption_index] == 0) return;
+
+    seen[assumption_index] = 1;
+    for (int i = (int)trail.size() - 1; i >= trail_limits[0]; i--) {
+        int variable = trail[i];
+        int literal_index = literal_to_variable_index(variable);
+        if (!seen[literal_index]) continue;
+        seen[literal_index] = 0;
+
+        ClauseRef reason = literal_antecedent[literal_index];
+        if (reason == no_clause) {
+            failed_assumption_literals.push_back(variable);
+            continue;
+        }
+        if (is_binary_reason(reason)) {
+            int other_index = literal_to_variable_index(binary_reason_literal(reason));
+            if (literal_decision_level[other_index] > 0) seen[other_index] = 1;
+            continue;
+        }
+        const int* clause = clause_arena.literals(reason);
+        uint32_t size = clause_arena.size(reason);
+        for (uint32_t j = 1; j < size; j++) {
+            int other_index = literal_to_variable_index(clause[j]);
+            if (literal_decision_level[other_index] > 0) seen[other_index] = 1;
+        }
+    }
+}
+
+int SATSolverCDCL::solve() {
+    return solve(std::vector<int>());
+}
+
+int SATSolverCDCL::solve(const std::vector<int>& assumption_literals) {
+    assumptions = assumption_literals;
+    for (int literal : assumptions) reserve_variables(std::abs(literal));
+    model_values.clear();
+    failed_assumption_literals.clear();
+    progress.start(options.progress_interval);
+
+    int result = CDCL();
+    if (result == RetVal::r_satisfied) model_values.assign(literals.begin(), literals.end());
+    // A refutation without assumptions ends the proof with the empty clause.
+    if (proof && result == RetVal::r_unsatisfied && failed_assumption_literals.empty()) proof->add(nullptr, 0);
+    assumptions.clear();
+    return result;
+}
+
+void SATSolverCDCL::report_progress() {
+    std::cout << progress.label() << stats.decisions << " decisions, " << stats.conflicts << " conflicts, "
+              << stats.propagations << " propagations, " << stats.restarts << " restarts, "
+              << learnt_clauses.size() << " learnt clauses" << std::endl;
+}
+
+void SATSolverCDCL::set_phases(const std::vector<int>& phases) {
+    size_t count = std::min(phases.size(), (size_t)literal_count);
+    for (size_t v = 0; v < count; v++) {
+        if (phases[v] == 0 || phases[v] == 1) saved_phase[v] = phases[v];
+    }
+}
+
+// Assigns and propagates literal on a fresh decision level, then undoes it.
+// Returns the number of literals it implied, or -1 if it led to a conflict.
+int SATSolverCDCL::lookahead(int literal) {
+    int level = (int)trail_limits.size() + 1;
+    size_t trail_before = trail.size();
+    new_decision_level();
+    assign_literal(literal, level, no_clause);
+
+    bool conflict = unit_propagate(level) == RetVal::r_unsatisfied;
+    int implied = (int)(trail.size() - trail_before);
+    backtrack(level - 1);
+    return conflict ? -1 : implied;
+}
+
+// Decides the cube's literals one level at a time from the root and
+// propagates each. Returns false if the cube is refuted on the way.
+bool SATSolverCDCL::assume_cube(const std::vector<int>& cube) {
+    if (!propagate_root()) return false;
+
+    for (int literal : cube) {
+        int value = literal_value(literal);
+        if (value == 0) return false;
+        int level = (int)trail_limits.size() + 1;
+        new_decision_level();
+        if (value == -1) {
+            assign_literal(literal, level, no_clause);
+            if (unit_propagate(level) == RetVal::r_unsatisfied) return false;
+        }
+    }
+    return true;
+}
+
+// Lookahead split: among the highest-ranked unassigned variables (by VSIDS
+// activity, then occurrence count) pick the one whose two branches together
+// imply the most literals. Returns the variable as a positive literal, 0 if
+// every variable is assigned, or -1 if some variable fails both ways, which
+// refutes the cube.
+int SATSolverCDCL::select_cube_split(const std::vector<int>& cube, int candidate_count) {
+    int result = 0;
+    if (!assume_cube(cube)) {
+        backtrack(0);
+        return -1;
+    }
+
+    std::vector<int> candidates;
+    for (int i = 0; i < literal_count; i++) {
+        if (literals[i] == -1) candidates.push_back(i);
+    }
+    auto ranks_higher = [this](int a, int b) {
+        if (activity[a] != activity[b]) return activity[a] > activity[b];
+        return original_literal_frequency[a] > original_literal_frequency[b];
+    };
+    if ((int)candidates.size() > candidate_count) {
+        std::partial_sort(candidates.begin(), candidates.begin() + candidate_count, candidates.end(), ranks_higher);
+        candidates.resize(candidate_count);
+    }
+
+    long long best_score = -1;
+    for (int candidate : candidates) {
+        int positive = lookahead(candidate + 1);
+        int negative = lookahead(-candidate - 1);
+        if (positive < 0 && negative < 0) {
+            result = -1;
+            break;
+        }
+        // A failing branch counts as if it had assigned everything.
+        long long positive_score = (positive < 0) ? literal_count : positive;
+        long long negative_score = (negative < 0) ? literal_count : negative;
+        long long score = (positive_score + 1) * (negative_score + 1);
+        if (score > best_score) {
+            best_score = score;
+            result = candidate + 1;
+        }
+    }
+    backtrack(0);
+    return result;
+}
+
+// Splits the formula into cubes by repeated lookahead up to the given depth.
+// Cubes refuted during lookahead are dropped; an empty result means UNSAT.
+std::vector<std::vector<int>> SATSolverCDCL::make_cubes(int depth, int candidate_count) {
+    std::vector<std::vector<int>> cubes;
+    std::vector<std::vector<int>> pending{{}};
+
+    while (!pending.empty()) {
+        std::vector<int> cube = std::move(pending.back());
+        pending.pop_back();
+
+        if ((int)cube.size() >= depth) {
+            cubes.push_back(cube);
+            continue;
+        }
+        int split = select_cube_split(cube, candidate_count);
+        if (split < 0) continue;
+        if (split == 0) {
+            cubes.push_back(cube);
+            continue;
+        }
+        cube.push_back(split);
+        pending.push_back(cube);
+        cube.back() = -split;
+        pending.push_back(cube);
+    }
+    return cubes;
+}
@@ -0,0 +1,440 @@
+#pragma once
+
+#include "dimacs_reader.h"
+#include "instrumentation.h"
+#include "budget.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+enum RetVal {
+    r_satisfied,
+    r_unsatisfied,
+    r_normal,
+    r_unknown
+};
+
+using ClauseRef = uint32_t;
+constexpr ClauseRef no_clause = UINT32_MAX;
+
+// Binary clauses are never looked up in the arena while propagating: their
+// watchers carry binary_watch instead of a clause reference and the other
+// literal as the blocker, and the literals they imply get a binary reason,
+// which stores that other literal's watch index under binary_reason_tag.
+// Arena offsets therefore stay below 2^31 words: ClauseArena::allocate
+// refuses to grow past that, and the solver ends the run with UNKNOWN.
+constexpr ClauseRef binary_watch = UINT32_MAX - 1;
+constexpr ClauseRef binary_reason_tag = 1u << 31;
+
+inline bool is_binary_reason(ClauseRef reason) {
+    return reason != no_clause && (reason & binary_reason_tag);
+}
+
+struct Watcher {
+    ClauseRef clause_ref;
+    int blocker;
+
+    bool binary() const { return clause_ref == binary_watch; }
+};
+
+enum class BranchingHeuristic {
+    vsids,
+    frequency
+};
+
+enum class RestartStrategy {
+    none,
+    luby,
+    glucose
+};
+
+// Polarity used for a variable that has no saved phase yet.
+enum class PolarityMode {
+    occurrence,
+    positive,
+    negative,
+    random
+};
+
+struct SolverOptions {
+    BranchingHeuristic branching_heuristic = BranchingHeuristic::vsids;
+    double variable_decay = 0.95;
+    bool phase_saving = true;
+    PolarityMode initial_polarity = PolarityMode::occurrence;
+    // Seed for the random generator; 0 draws one from std::random_device.
+    unsigned seed = 0;
+    // Start VSIDS from small random activities instead of all zeros.
+    bool randomize_activity = false;
+
+    RestartStrategy restart_strategy = RestartStrategy::glucose;
+    int luby_unit = 100;
+    double restart_fast_alpha = 1.0 / 32;
+    double restart_slow_alpha = 1.0 / 4096;
+    double restart_margin = 1.25;
+    int restart_min_conflicts = 50;
+
+    // Learnt clause database reduction; an interval of 0 keeps every clause.
+    int reduce_interval = 2000;
+    int reduce_increment = 300;
+    int core_lbd = 2;
+    int tier2_lbd = 6;
+
+    // Recursive learnt clause minimization: drop every literal whose reasons
+    // lead back to other literals of the clause.
+    bool minimize_learnt = true;
+
+    // Portfolio clause sharing: learnt clauses with LBD up to this bound (and
+    // short enough for the exchange) are published. 0 disables sharing.
+    int share_max_lbd = 2;
+
+    // Cube-and-conquer: split by lookahead to this depth before solving, 0
+    // disables it. A cube whose solver spends more than cube_conflicts
+    // conflicts (doubled per level below the initial depth) is split again.
+    int cube_depth = 0;
+    long long cube_conflicts = 1000;
+    int cube_candidates = 32;
+
+    // Time propagation, analysis and branching (reported by --stats), and
+    // print a progress line every progress_interval seconds (0 never).
+    bool time_phases = false;
+    double progress_interval = 0.0;
+
+    // Resource limits, counted from initialize() across every solve call
+    // until the next one. Running out makes solve() return r_unknown.
+    BudgetLimits limits;
+};
+
+struct SolverStats {
+    long long decisions = 0;
+    long long conflicts = 0;
+    long long propagations = 0;
+    long long restarts = 0;
+    long long reductions = 0;
+    long long deleted_clauses = 0;
+    long long garbage_collections = 0;
+    long long exported_clauses = 0;
+    long long imported_clauses = 0;
+    // Instrumentation only: clauses whose literals unit_propagate had to
+    // read, binary clauses it resolved from the watcher alone, literals in
+    // learnt clauses and those minimization removed from them, and
+    // per-phase wall-clock time.
+    long long clause_visits = 0;
+    long long binary_visits = 0;
+    long long learnt_literals = 0;
+    long long minimized_literals = 0;
+    PhaseTimes times;
+};
+
+// Learnt clauses are sorted into tiers by LBD. Core clauses are kept
+// forever, tier 2 clauses are kept while they keep taking part in conflicts
+// and local clauses compete for survival at every reduction.
+enum class ClauseTier {
+    original,
+    core,
+    tier2,
+    local
+};
+
+// All clauses live in one flat buffer of 32-bit words and are referenced by
+// the offset of their header. A clause is a three-word header followed by its
+// literals:
+//   word 0: number of literals
+//   word 1: learnt, deleted and relocated bits, tier, used counter and LBD
+//   word 2: activity as a float, or the new offset once relocated
+class ClauseArena {
+private:
+    std::vector<uint32_t> memory;
+    size_t wasted_words = 0;
+
+    static constexpr uint32_t learnt_bit = 1u << 0;
+    static constexpr uint32_t deleted_bit = 1u << 1;
+    static constexpr uint32_t relocated_bit = 1u << 2;
+    static constexpr int tier_shift = 3;
+    static constexpr int used_shift = 5;
+    static constexpr int lbd_shift = 7;
+    static constexpr uint32_t lbd_limit = (1u << (32 - lbd_shift)) - 1;
+
+    uint32_t get_bits(ClauseRef ref, int shift, uint32_t mask) const { return (memory[ref + 1] >> shift) & mask; }
+    void set_bits(ClauseRef ref, int shift, uint32_t mask, uint32_t value) {
+        memory[ref + 1] = (memory[ref + 1] & ~(mask << shift)) | ((value & mask) << shift);
+    }
+
+public:
+    static constexpr size_t header_words = 3;
+    // Every offset must stay clear of binary_reason_tag.
+    static constexpr size_t max_words = binary_reason_tag;
+
+    void clear() { memory.clear(); wasted_words = 0; }
+    void reserve(size_t words) { memory.reserve(words); }
+    size_t size_in_words() const { return memory.size(); }
+    size_t wasted() const { return wasted_words; }
+
+    // Returns no_clause, storing nothing, if the clause would not fit below
+    // max_words.
+    ClauseRef allocate(const int* clause_literals, size_t size, bool learnt);
+    void free_clause(ClauseRef ref);
+    void relocate(ClauseRef& ref, ClauseArena& to);
+    void swap(ClauseArena& other) { memory.swap(other.memory); std::swap(wasted_words, other.wasted_words); }
+
+    uint32_t size(ClauseRef ref) const { return memory[ref]; }
+    int* literals(ClauseRef ref) { return reinterpret_cast<int*>(&memory[ref + header_words]); }
+    bool learnt(ClauseRef ref) const { return memory[ref + 1] & learnt_bit; }
+    bool deleted(ClauseRef ref) const { return memory[ref + 1] & deleted_bit; }
+
+    ClauseTier tier(ClauseRef ref) const { return (ClauseTier)get_bits(ref, tier_shift, 3); }
+    void set_tier(ClauseRef ref, ClauseTier tier) { set_bits(ref, tier_shift, 3, (uint32_t)tier); }
+    int used(ClauseRef ref) const { return (int)get_bits(ref, used_shift, 3); }
+    void set_used(ClauseRef ref, int used) { set_bits(ref, used_shift, 3, (uint32_t)used); }
+    int lbd(ClauseRef ref) const { return (int)get_bits(ref, lbd_shift, lbd_limit); }
+    void set_lbd(ClauseRef ref, int lbd) { set_bits(ref, lbd_shift, lbd_limit, std::min((uint32_t)lbd, lbd_limit)); }
+
+    float activity(ClauseRef ref) const {
+        float value;
+        std::memcpy(&value, &memory[ref + 2], sizeof(value));
+        return value;
+    }
+    void set_activity(ClauseRef ref, float value) { std::memcpy(&memory[ref + 2], &value, sizeof(value)); }
+};
+
+// Binary max-heap of variable indices ordered by activity. Assigned variables
+// are left in place and skipped when popped; unassigning a variable puts it
+// back in if it is missing.
+class VariableOrderHeap {
+private:
+    const std::vector<double>& activity;
+    std::vector<int> heap;
+    std::vector<int> position;
+
+    bool before(int a, int b) const { return activity[a] > activity[b]; }
+    void sift_up(int i);
+    void sift_down(int i);
+
+public:
+    explicit VariableOrderHeap(const std::vector<double>& activity) : activity(activity) {}
+
+    void reset(int variable_count);
+    void grow(int variable_count);
+    bool empty() const { return heap.empty(); }
+    bool contains(int variable) const { return position[variable] != -1; }
+    void insert(int variable);
+    void increased(int variable) { if (contains(variable)) sift_up(position[variable]); }
+    int pop();
+};
+
+// Lock-free bounded broadcast buffer for short learnt clauses. A producer
+// claims a position with a single fetch_add and publishes the clause under a
+// per-slot sequence number (odd while writing, 2 * position + 2 when done).
+// Every consumer keeps its own read position; clauses that were overwritten
+// before a consumer got to them are simply skipped.
+class ClauseExchange {
+public:
+    static constexpr int max_clause_size = 8;
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> sequence{0};
+        std::atomic<int> producer{-1};
+        std::atomic<int> size{0};
+        std::atomic<int> lbd{0};
+        std::atomic<int> literals[max_clause_size];
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    uint64_t capacity;
+    std::atomic<uint64_t> write_position{0};
+
+public:
+    explicit ClauseExchange(int capacity_log2 = 14)
+        : slots(new Slot[(size_t)1 << capacity_log2]), capacity((uint64_t)1 << capacity_log2) {}
+
+    void publish(int producer, const int* clause, int size, int lbd);
+    bool fetch(int consumer, uint64_t& read_position, std::vector<int>& clause, int& lbd);
+};
+
+class RestartPolicy;
+class DratWriter;
+
+// Conflict-driven clause learning solver. A solver object can be loaded
+// from a parsed formula or built up clause by clause, and then solved any
+// number of times under different assumptions; learnt clauses, activities
+// and saved phases carry over from one call to the next.
+class SATSolverCDCL {
+private:
+    std::vector<int> literals;
+    ClauseArena clause_arena;
+    std::vector<ClauseRef> original_clauses;
+    std::vector<ClauseRef> learnt_clauses;
+    
+    std::vector<int> literal_frequency;
+    std::vector<int> literal_polarity;
+    std::vector<int> original_literal_frequency;
+    
+    std::vector<int> literal_decision_level;
+    std::vector<ClauseRef> literal_antecedent;
+
+    // watches[literal_to_watch_index(l)] lists the clauses currently watching l.
+    // Every clause of size >= 2 watches its first two literals.
+    std::vector<std::vector<Watcher>> watches;
+    std::vector<int> trail;
+    std::vector<ClauseRef> unit_clauses;
+    size_t propagation_head = 0;
+
+    // trail_limits[d] is the trail size when decision level d + 1 was opened.
+    std::vector<int> trail_limits;
+    std::vector<char> seen;
+    std::vector<int> learnt_clause;
+
+    // Minimization state: a depth-first walk over reasons, and every
+    // variable whose seen mark it set.
+    struct MinimizeFrame {
+        uint32_t index;
+        int literal;
+    };
+    std::vector<MinimizeFrame> minimize_stack;
+    std::vector<int> minimize_marked;
+    
+    int literal_count = 0;
+    int clause_count = 0;
+    int assigned_literal_count = 0;
+    ClauseRef kappa_antecedent = no_clause;
+    // For a binary conflict, kappa_antecedent is the binary reason of one
+    // literal and this is the other.
+    int kappa_literal = 0;
+    int pick_counter = 0;
+    bool already_unsatisfied = false;
+
+    std::random_device random_generator;
+    std::mt19937 generator;
+
+    SolverOptions options;
+    std::vector<double> activity;
+    double activity_increment = 1.0;
+    VariableOrderHeap order_heap;
+
+    // Last value each variable held before it was unassigned, -1 if never set.
+    std::vector<int> saved_phase;
+    std::vector<int> level_stamp;
+    int current_stamp = 0;
+    std::unique_ptr<RestartPolicy> restart_policy;
+    SolverStats stats;
+    DimacsLoadStats load_stats;
+    ProgressClock progress;
+    Budget budget;
+
+    float clause_activity_increment = 1.0f;
+    long long next_reduction = 0;
+    int reduction_count = 0;
+
+    // Portfolio support: an external stop request and the shared exchange.
+    const std::atomic<bool>* terminate_flag = nullptr;
+    ClauseExchange* clause_exchange = nullptr;
+    int worker_id = 0;
+    uint64_t exchange_read_position = 0;
+    std::vector<int> imported_clause;
+
+    // Proof output: learnt clauses, deletions and the final empty clause.
+    DratWriter* proof = nullptr;
+
+    std::vector<int> assumptions;
+    long long conflict_budget = -1;
+    std::vector<int> added_clause;
+    std::vector<int> model_values;
+    std::vector<int> failed_assumption_literals;
+
+    void reset();
+    void reserve_variables(int count);
+    void new_decision_level();
+    int CDCL();
+    void report_progress();
+    void analyze_final(int literal);
+
+    int unit_propagate(int decision_level);
+    void assign_literal(int variable, int decision_level, ClauseRef antecedent);
+    void unassign_literal(int literal_index);
+    int literal_to_variable_index(int variable);
+    int literal_to_watch_index(int variable);
+    int literal_value(int variable);
+    ClauseRef binary_reason(int other_literal);
+    int binary_reason_literal(ClauseRef reason);
+    void attach_clause(ClauseRef clause_ref);
+    int conflict_analysis_and_backtrack(int decision_level);
+    uint32_t reason_size(ClauseRef reason);
+    int reason_literal(ClauseRef reason, uint32_t index);
+    bool literal_redundant(int literal, uint32_t abstract_levels);
+    void minimize_learnt_clause();
+    void backtrack(int decision_level);
+    int pick_branching_variable();
+    int pick_frequency_variable();
+    int pick_activity_variable();
+    int choose_polarity(int literal_index);
+    int compute_lbd(const int* clause, size_t size);
+    ClauseTier tier_for_lbd(int lbd);
+    ClauseRef store_learnt_clause(const std::vector<int>& clause, int lbd);
+    void bump_clause(ClauseRef clause_ref);
+    bool clause_locked(ClauseRef clause_ref);
+    void reduce_learnt_clauses();
+    void collect_garbage();
+    void bump_variable_activity(int literal_index);
+    void decay_variable_activities();
+    bool all_variables_assigned();
+    bool import_shared_clauses();
+    bool propagate_root();
+    int lookahead(int literal);
+    bool assume_cube(const std::vector<int>& cube);
+
+public:
+    SATSolverCDCL();
+    explicit SATSolverCDCL(const SolverOptions& options);
+    ~SATSolverCDCL();
+
+    // Replaces everything the solver holds with the given formula.
+    void initialize(const DimacsFormula& formula);
+
+    // Adds a clause over variables 1, 2, ...; unseen variables are created on
+    // the fly. Returns false once the clauses are unsatisfiable at the root.
+    bool add_clause(const int* clause, size_t size);
+    bool add_clause(const std::vector<int>& clause) { return add_clause(clause.data(), clause.size()); }
+
+    // Returns r_satisfied, r_unsatisfied, or r_unknown when a conflict budget
+    // or the terminate flag stopped the search. With assumptions the answer
+    // is relative to them: the literals are forced true for this call only.
+    int solve();
+    int solve(const std::vector<int>& assumptions);
+
+    // After r_satisfied, model()[v] is 0 or 1 for variable v + 1.
+    const std::vector<int>& model() const { return model_values; }
+    // After r_unsatisfied, the assumptions that together contradict the
+    // clauses; empty if the clauses are unsatisfiable on their own.
+    const std::vector<int>& failed_assumptions() const { return failed_assumption_literals; }
+    int variable_count() const { return literal_count; }
+
+    // Seeds the saved phase of variable v + 1 with phases[v] (0 or 1), for
+    // example from a local search assignment. Call after the clauses are in.
+    void set_phases(const std::vector<int>& phases);
+
+    int select_cube_split(const std::vector<int>& cube, int candidate_count);
+    std::vector<std::vector<int>> make_cubes(int depth, int candidate_count);
+    bool formula_unsatisfiable() const { return already_unsatisfied; }
+    void set_conflict_budget(long long conflicts) { conflict_budget = conflicts; }
+    const SolverStats& get_stats() const { return stats; }
+    // Which resource limit ended the last r_unknown, if any.
+    const Budget& get_budget() const { return budget; }
+    const DimacsLoadStats& get_load_stats() const { return load_stats; }
+    size_t clause_memory_bytes() const { return clause_arena.size_in_words() * sizeof(uint32_t); }
+
+    void set_terminate_flag(const std::atomic<bool>* flag) { terminate_flag = flag; }
+    void set_clause_exchange(ClauseExchange* exchange, int id) {
+        clause_exchange = exchange;
+        worker_id = id;
+    }
+    // Logs a DRAT proof of every UNSAT answer to writer. The proof refers to
+    // the clauses as given, so it is only checkable for a solver that does
+    // not import shared clauses and is not solving under assumptions.
+    void set_proof(DratWriter* writer) { proof = writer; }
+};
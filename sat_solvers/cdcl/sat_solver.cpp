@@ -1,356 +1,673 @@
+#include "cdcl_solver.h"
+#include "sls_solver.h"
+#include "dimacs_reader.h"
+#include "two_sat.h"
+#include "preprocessor.h"
+#include "drat_writer.h"
+#include "batch_server.h"
+
 #include <algorithm>
-#include <cmath>
-#include <iostream>
-#include <random>
-#include <vector>
-#include <fstream>
+#include <atomic>
 #include <chrono>
-#include <iomanip>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
 #include <string>
-#include <sstream>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Worker 0 runs the options as given; the others vary seed, initial
+// polarity, restart policy and decay so the portfolio explores different
+// parts of the search space.
+SolverOptions diversify_options(const SolverOptions& base, int worker) {
+    SolverOptions options = base;
+    if (worker == 0) return options;
+    // One progress reporter is enough and keeps the lines from interleaving.
+    options.progress_interval = 0.0;
+
+    options.seed = (base.seed != 0 ? base.seed : 0x9e3779b9u) + (unsigned)worker * 7919u;
+    options.randomize_activity = true;
+
+    static const PolarityMode polarities[] = {PolarityMode::negative, PolarityMode::positive,
+                                              PolarityMode::random, PolarityMode::occurrence};
+    options.initial_polarity = polarities[(worker - 1) % 4];
+
+    if (worker % 2 == 1) {
+        options.restart_strategy = RestartStrategy::luby;
+        options.luby_unit = 64 << ((worker / 2) % 3);
+    } else {
+        options.restart_strategy = RestartStrategy::glucose;
+        options.restart_margin = 1.1 + 0.1 * ((worker / 2) % 4);
+    }
+    options.variable_decay = (worker % 3 == 0) ? 0.90 : (worker % 3 == 1) ? 0.95 : 0.99;
+    return options;
+}
 
-enum RetVal {
-    r_satisfied,
-    r_unsatisfied,
-    r_normal
+struct PortfolioResult {
+    int result = RetVal::r_unknown;
+    int winner = -1;
+    SolverStats winner_stats;
+    BudgetLimit exceeded = BudgetLimit::none;
 };
 
-class SATSolverCDCL {
+// Runs one diversified solver per thread. The first worker to reach a
+// definitive answer raises the shared stop flag, which the others poll once
+// per decision. Seed phases, if any, go to worker 0 only, so the others keep
+// their own polarities.
+PortfolioResult solve_portfolio(const DimacsFormula& formula, const SolverOptions& base_options, int thread_count,
+                                const std::vector<int>& phases) {
+    std::atomic<bool> stop{false};
+    std::atomic<int> winner{-1};
+    ClauseExchange exchange;
+    std::vector<std::unique_ptr<SATSolverCDCL>> solvers(thread_count);
+    std::vector<int> results(thread_count, RetVal::r_unknown);
+    std::vector<std::thread> threads;
+
+    for (int worker = 0; worker < thread_count; worker++) {
+        threads.emplace_back([&, worker]() {
+            solvers[worker] = std::make_unique<SATSolverCDCL>(diversify_options(base_options, worker));
+            SATSolverCDCL& solver = *solvers[worker];
+            solver.set_terminate_flag(&stop);
+            if (base_options.share_max_lbd > 0) solver.set_clause_exchange(&exchange, worker);
+            solver.initialize(formula);
+            if (worker == 0) solver.set_phases(phases);
+
+            results[worker] = solver.solve();
+            if (results[worker] != RetVal::r_unknown) {
+                int expected = -1;
+                winner.compare_exchange_strong(expected, worker);
+                stop.store(true, std::memory_order_relaxed);
+            }
+        });
+    }
+    for (std::thread& thread : threads) thread.join();
+
+    PortfolioResult portfolio;
+    portfolio.winner = winner.load();
+    if (portfolio.winner != -1) {
+        portfolio.result = results[portfolio.winner];
+        portfolio.winner_stats = solvers[portfolio.winner]->get_stats();
+    } else {
+        // Every worker ran out of budget; report worker 0's search.
+        portfolio.winner_stats = solvers[0]->get_stats();
+        portfolio.exceeded = solvers[0]->get_budget().exceeded();
+    }
+    return portfolio;
+}
+
+// Cubes owned by one worker. The owner pushes and pops at the back, so it
+// keeps working depth-first on the cubes it split itself; idle workers steal
+// from the front, where the oldest and usually largest cubes wait.
+class CubeDeque {
 private:
-    std::vector<int> literals;
-    std::vector<std::vector<int>> literal_list_per_clause;
-    
-    std::vector<int> literal_frequency;
-    std::vector<int> literal_polarity;
-    std::vector<int> original_literal_frequency;
-    
-    std::vector<int> literal_decision_level;
-    std::vector<int> literal_antecedent;
-    
-    int literal_count = 0;
-    int clause_count = 0;
-    int assigned_literal_count = 0;
-    int kappa_antecedent = -1;
-    int pick_counter = 0;
-    bool already_unsatisfied = false;
-
-    std::random_device random_generator;
-    std::mt19937 generator;
-
-    int unit_propagate(int decision_level);
-    void assign_literal(int variable, int decision_level, int antecedent);
-    void unassign_literal(int literal_index);
-    int literal_to_variable_index(int variable);
-    int conflict_analysis_and_backtrack(int decision_level);
-    std::vector<int>& resolve(std::vector<int>& input_clause, int literal);
-    int pick_branching_variable();
-    bool all_variables_assigned();
+    std::mutex mutex;
+    std::deque<std::vector<int>> cubes;
 
 public:
-    SATSolverCDCL() : generator(random_generator()) {}
-    
-    void initialize(const std::string& filename);
-    
-    int CDCL();
-    int solve();
-};
+    void push(std::vector<int> cube) {
+        std::lock_guard<std::mutex> lock(mutex);
+        cubes.push_back(std::move(cube));
+    }
 
-void SATSolverCDCL::initialize(const std::string& filename) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        std::cerr << "Error: Could not open file " << filename << "\n";
-        exit(1);
+    bool pop(std::vector<int>& cube) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (cubes.empty()) return false;
+        cube = std::move(cubes.back());
+        cubes.pop_back();
+        return true;
     }
 
-    std::string line;
-    already_unsatisfied = false;
-    
-    while (std::getline(file, line)) {
-        if (line.empty() || line[0] == 'c') continue;
-        if (line[0] == 'p') {
-            std::istringstream iss(line);
-            std::string temp;
-            iss >> temp >> temp >> literal_count >> clause_count;
-            break;
-        }
+    bool steal(std::vector<int>& cube) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (cubes.empty()) return false;
+        cube = std::move(cubes.front());
+        cubes.pop_front();
+        return true;
     }
+};
 
-    assigned_literal_count = 0;
-    kappa_antecedent = -1;
-    pick_counter = 0;
-
-    literals.assign(literal_count, -1);
-    literal_frequency.assign(literal_count, 0);
-    literal_polarity.assign(literal_count, 0);
-    literal_list_per_clause.resize(clause_count);
-    literal_antecedent.assign(literal_count, -1);
-    literal_decision_level.assign(literal_count, -1);
-
-    int literal;
-    for (int i = 0; i < clause_count; ++i) {
-        int literal_count_in_clause = 0;
-        while (file >> literal && literal != 0) {
-            literal_list_per_clause[i].push_back(literal);
-            
-            int lit_idx = (literal > 0) ? (literal - 1) : (-literal - 1);
-            if (lit_idx < literal_count) {
-                literal_frequency[lit_idx]++;
-                if (literal > 0) literal_polarity[lit_idx]++;
-                else literal_polarity[lit_idx]--;
-            }
-            literal_count_in_clause++;
-        }
-        
-        if (literal_count_in_clause == 0 && !file.eof()) {
-            already_unsatisfied = true;
-        }
+struct CubeAndConquerResult {
+    int result = RetVal::r_unknown;
+    long long initial_cubes = 0;
+    long long splits = 0;
+    long long steals = 0;
+    SolverStats total_stats;
+    BudgetLimit exceeded = BudgetLimit::none;
+};
+
+// Splits the formula into cubes by lookahead, deals them round-robin to one
+// deque per worker and lets every worker solve its cubes under assumptions
+// with a reusable solver. A cube that exhausts its conflict budget is split
+// again and both halves go back on the worker's own deque. The formula is
+// UNSAT once every cube is refuted and SAT as soon as any cube has a model.
+CubeAndConquerResult solve_cube_and_conquer(const DimacsFormula& formula, const SolverOptions& base_options,
+                                            int thread_count, const std::vector<int>& phases) {
+    CubeAndConquerResult outcome;
+
+    std::vector<std::vector<int>> cubes;
+    {
+        SATSolverCDCL cuber(base_options);
+        cuber.initialize(formula);
+        cubes = cuber.make_cubes(base_options.cube_depth, base_options.cube_candidates);
+    }
+    outcome.initial_cubes = (long long)cubes.size();
+    if (cubes.empty()) {
+        outcome.result = RetVal::r_unsatisfied;
+        return outcome;
     }
-    
-    original_literal_frequency = literal_frequency;
-    file.close();
-}
 
-int SATSolverCDCL::unit_propagate(int decision_level) {
-    bool unit_clause_found = false;
-    size_t false_count = 0;
-    size_t unset_count = 0;
-    int last_unset_literal_idx = -1;
-    bool satisfied_flag = false;
-
-    do {
-        unit_clause_found = false;
-        for (size_t i = 0; i < literal_list_per_clause.size() && !unit_clause_found; i++) {
-            false_count = 0;
-            unset_count = 0;
-            satisfied_flag = false;
-
-            for (size_t j = 0; j < literal_list_per_clause[i].size(); j++) {
-                int variable = literal_list_per_clause[i][j];
-                int literal_index = literal_to_variable_index(variable);
-
-                if (literals[literal_index] == -1) {
-                    unset_count++;
-                    last_unset_literal_idx = (int)j;
-                } else if ((literals[literal_index] == 0 && variable > 0) ||
-                           (literals[literal_index] == 1 && variable < 0)) {
-                    false_count++;
-                } else {
-                    satisfied_flag = true;
-                    break;
+    std::vector<std::unique_ptr<CubeDeque>> deques;
+    for (int worker = 0; worker < thread_count; worker++) deques.push_back(std::make_unique<CubeDeque>());
+    for (size_t i = 0; i < cubes.size(); i++) deques[i % thread_count]->push(std::move(cubes[i]));
+
+    std::atomic<bool> stop{false};
+    std::atomic<int> result{RetVal::r_unknown};
+    std::atomic<long long> pending{outcome.initial_cubes};
+    std::atomic<long long> splits{0};
+    std::atomic<long long> steals{0};
+    ClauseExchange exchange;
+    std::vector<SolverStats> worker_stats(thread_count);
+    std::vector<BudgetLimit> exceeded(thread_count, BudgetLimit::none);
+    std::vector<std::thread> threads;
+
+    auto finish = [&](int answer) {
+        int expected = RetVal::r_unknown;
+        result.compare_exchange_strong(expected, answer);
+        stop.store(true, std::memory_order_relaxed);
+    };
+
+    for (int worker = 0; worker < thread_count; worker++) {
+        threads.emplace_back([&, worker]() {
+            SATSolverCDCL solver(diversify_options(base_options, worker));
+            solver.set_terminate_flag(&stop);
+            if (thread_count > 1 && base_options.share_max_lbd > 0) solver.set_clause_exchange(&exchange, worker);
+            solver.initialize(formula);
+            solver.set_phases(phases);
+
+            std::vector<int> cube;
+            while (!stop.load(std::memory_order_relaxed)) {
+                if (!deques[worker]->pop(cube)) {
+                    bool stolen = false;
+                    for (int offset = 1; offset < thread_count && !stolen; offset++) {
+                        stolen = deques[(worker + offset) % thread_count]->steal(cube);
+                    }
+                    if (!stolen) {
+                        if (pending.load() == 0) break;
+                        std::this_thread::yield();
+                        continue;
+                    }
+                    steals++;
                 }
-            }
-
-            if (satisfied_flag) continue;
 
-            if (unset_count == 1) {
-                assign_literal(literal_list_per_clause[i][last_unset_literal_idx], decision_level, (int)i);
-                unit_clause_found = true;
-                break;
-            } else if (false_count == literal_list_per_clause[i].size()) {
-                kappa_antecedent = (int)i;
-                return RetVal::r_unsatisfied;
+                int extra_depth = std::min(std::max(0, (int)cube.size() - base_options.cube_depth), 20);
+                solver.set_conflict_budget(base_options.cube_conflicts << extra_depth);
+                int cube_result = solver.solve(cube);
+
+                if (cube_result == RetVal::r_satisfied) {
+                    finish(RetVal::r_satisfied);
+                } else if (cube_result == RetVal::r_unsatisfied) {
+                    if (solver.formula_unsatisfiable()) finish(RetVal::r_unsatisfied);
+                    else if (pending.fetch_sub(1) == 1) finish(RetVal::r_unsatisfied);
+                } else if (solver.get_budget().exceeded() != BudgetLimit::none) {
+                    exceeded[worker] = solver.get_budget().exceeded();
+                    finish(RetVal::r_unknown);
+                } else if (!stop.load(std::memory_order_relaxed)) {
+                    int split = solver.select_cube_split(cube, base_options.cube_candidates);
+                    if (split < 0) {
+                        if (pending.fetch_sub(1) == 1) finish(RetVal::r_unsatisfied);
+                        continue;
+                    }
+                    if (split == 0) {
+                        // The cube propagated to a full assignment without a conflict.
+                        finish(RetVal::r_satisfied);
+                        continue;
+                    }
+                    pending.fetch_add(1);
+                    splits++;
+                    cube.push_back(split);
+                    deques[worker]->push(cube);
+                    cube.back() = -split;
+                    deques[worker]->push(cube);
+                }
             }
-        }
-    } while (unit_clause_found);
+            worker_stats[worker] = solver.get_stats();
+        });
+    }
+    for (std::thread& thread : threads) thread.join();
 
-    kappa_antecedent = -1;
-    return RetVal::r_normal;
+    outcome.result = result.load();
+    outcome.splits = splits.load();
+    outcome.steals = steals.load();
+    for (BudgetLimit limit : exceeded) {
+        if (limit != BudgetLimit::none) outcome.exceeded = limit;
+    }
+    for (const SolverStats& stats : worker_stats) {
+        outcome.total_stats.decisions += stats.decisions;
+        outcome.total_stats.conflicts += stats.conflicts;
+        outcome.total_stats.propagations += stats.propagations;
+        outcome.total_stats.restarts += stats.restarts;
+        outcome.total_stats.clause_visits += stats.clause_visits;
+        outcome.total_stats.binary_visits += stats.binary_visits;
+        outcome.total_stats.learnt_literals += stats.learnt_literals;
+        outcome.total_stats.minimized_literals += stats.minimized_literals;
+        for (int phase = 0; phase < phase_count; phase++) {
+            outcome.total_stats.times.milliseconds[phase] += stats.times.milliseconds[phase];
+        }
+    }
+    return outcome;
 }
 
-void SATSolverCDCL::assign_literal(int variable, int decision_level, int antecedent) {
-    int literal_index = literal_to_variable_index(variable);
-    int value = (variable > 0) ? 1 : 0;
-    
-    literals[literal_index] = value;
-    literal_decision_level[literal_index] = decision_level;
-    literal_antecedent[literal_index] = antecedent;
-    
-    literal_frequency[literal_index] = -1; 
-    assigned_literal_count++;
+// The --stats lines every mode shares. Phase shares are taken of busy_ms,
+// the run time summed over all workers.
+void report_search_stats(const SolverStats& stats, double busy_ms) {
+    std::cout << "c decisions: " << stats.decisions << "\n"
+              << "c conflicts: " << stats.conflicts << "\n"
+              << "c propagations: " << stats.propagations << "\n"
+              << "c restarts:  " << stats.restarts << "\n";
+#if SAT_INSTRUMENTATION
+    std::cout << "c clause visits: " << stats.clause_visits << " ("
+              << (stats.propagations ? (double)stats.clause_visits / stats.propagations : 0.0)
+              << " per propagation)\n"
+              << "c binary visits: " << stats.binary_visits << " ("
+              << (stats.propagations ? (double)stats.binary_visits / stats.propagations : 0.0)
+              << " per propagation)\n"
+              << "c learnt literals: " << stats.learnt_literals << " ("
+              << (stats.conflicts ? (double)stats.learnt_literals / stats.conflicts : 0.0) << " per conflict, "
+              << stats.minimized_literals << " removed by minimization)\n";
+#endif
+    report_phase_times(stats.times, busy_ms);
 }
 
-void SATSolverCDCL::unassign_literal(int literal_index) {
-    literals[literal_index] = -1;
-    literal_decision_level[literal_index] = -1;
-    literal_antecedent[literal_index] = -1;
-    literal_frequency[literal_index] = original_literal_frequency[literal_index];
-    assigned_literal_count--;
-}
+// Batch mode keeps one solver per pool thread and reloads it for every
+// instance, each of which is solved by that single solver.
+class CDCLBatchWorker : public BatchWorker {
+private:
+    SATSolverCDCL solver;
+    bool use_two_sat;
+    bool preprocess;
+    Preprocessor preprocessor;
+    DimacsFormula reduced;
+    std::vector<int> model;
+
+public:
+    CDCLBatchWorker(const SolverOptions& options, bool use_two_sat, bool preprocess)
+        : solver(options), use_two_sat(use_two_sat), preprocess(preprocess) {}
+
+    const char* solve(const DimacsFormula& formula) override {
+        const DimacsFormula* input = &formula;
+        if (preprocess) {
+            if (!preprocessor.run(formula, reduced)) return "UNSAT";
+            input = &reduced;
+        }
+        if (use_two_sat && is_two_sat(*input)) return solve_two_sat(*input, model) ? "SAT" : "UNSAT";
 
-int SATSolverCDCL::literal_to_variable_index(int variable) {
-    return (variable > 0) ? variable - 1 : -variable - 1;
+        solver.initialize(*input);
+        int result = solver.solve();
+        return (result == RetVal::r_satisfied) ? "SAT" : (result == RetVal::r_unsatisfied) ? "UNSAT" : "UNKNOWN";
+    }
+};
+
+void print_usage() {
+    std::cerr << "Usage: ./cdcl_solver [options] <input_file.cnf | ->\n"
+              << "       ./cdcl_solver --batch [options]     solve the instances named on standard input\n"
+              << "Options:\n"
+              << "  --heuristic <vsids|frequency>  Branching heuristic (default: vsids)\n"
+              << "  --var-decay <factor>           VSIDS activity decay in (0, 1) (default: 0.95)\n"
+              << "  --no-phase-saving              Pick polarity from occurrence counts only\n"
+              << "  --restart <none|luby|glucose>  Restart policy (default: glucose)\n"
+              << "  --luby-unit <conflicts>        Conflicts per Luby unit (default: 100)\n"
+              << "  --restart-margin <factor>      Glucose: restart when fast LBD average exceeds\n"
+              << "                                 factor * slow average (default: 1.25)\n"
+              << "  --restart-fast-alpha <alpha>   Glucose: fast LBD average smoothing (default: 1/32)\n"
+              << "  --restart-slow-alpha <alpha>   Glucose: slow LBD average smoothing (default: 1/4096)\n"
+              << "  --restart-min-conflicts <n>    Glucose: conflicts between restarts (default: 50)\n"
+              << "  --reduce-interval <conflicts>  Conflicts before the first learnt clause reduction,\n"
+              << "                                 0 keeps every learnt clause (default: 2000)\n"
+              << "  --reduce-increment <conflicts> Growth of the interval after each reduction (default: 300)\n"
+              << "  --no-minimize                  Keep learnt clauses as conflict analysis derives them\n"
+              << "  --threads <n>                  Run a portfolio of n diversified solvers (default: 1)\n"
+              << "  --share-lbd <k>                Portfolio: share learnt clauses with LBD <= k,\n"
+              << "                                 0 disables sharing (default: 2)\n"
+              << "  --cube-depth <d>               Cube-and-conquer: split into up to 2^d cubes by lookahead\n"
+              << "                                 and solve them on --threads workers (default: 0, off)\n"
+              << "  --cube-conflicts <n>           Conflicts a cube may use before it is split again\n"
+              << "                                 (default: 1000)\n"
+              << "  --sls <flips>                  Run probSAT local search for up to this many flips\n"
+              << "                                 first; if it finds no model, its best assignment\n"
+              << "                                 seeds the CDCL phases (default: 0, off)\n"
+              << "  --seed <n>                     Random seed, 0 for a random one (default: 0)\n"
+              << "  --polarity <occurrence|positive|negative|random>\n"
+              << "                                 Phase for unassigned variables without a saved one\n"
+              << "  --no-2sat                      Do not hand all-binary formulas to the 2-SAT engine\n"
+              << "  --preprocess                   Simplify the formula first (dedup, subsumption,\n"
+              << "                                 strengthening, failed literal probing)\n"
+              << "  --stats                        Print search statistics and per-phase times after the result\n"
+              << "  --progress <seconds>           Print a progress line at this interval (default: 0, off)\n"
+              << "  --proof <file>                 Write a binary DRAT proof; needs a single solver and\n"
+              << "                                 no preprocessing, and bypasses the 2-SAT engine\n"
+              << "Batch mode (one request per line: a path, or \"@cnf <bytes>\" and the DIMACS text):\n"
+              << "  --batch                        Serve requests from standard input\n"
+              << "  --socket <path>                Serve requests on a Unix socket until \"@quit\"\n"
+              << "  --workers <n>                  Solver threads (default: one per hardware thread)\n"
+              << "  --completion-order             Answer as instances finish, not in request order\n";
+    print_budget_usage(std::cerr, search_budgets);
 }
 
-int SATSolverCDCL::conflict_analysis_and_backtrack(int decision_level) {
-    std::vector<int> learnt_clause = literal_list_per_clause[kappa_antecedent];
-    int conflict_decision_level = decision_level;
-    int this_level_count = 0;
-    int resolver_literal_idx = 0;
-
-    do {
-        this_level_count = 0;
-        for (int variable : learnt_clause) {
-            int lit_idx = literal_to_variable_index(variable);
-            if (literal_decision_level[lit_idx] == conflict_decision_level) {
-                this_level_count++;
+bool parse_arguments(int argc, char* argv[], SolverOptions& options, std::string& filename, bool& print_stats,
+                     bool& use_two_sat, bool& preprocess, int& thread_count, long long& sls_flips,
+                     std::string& proof_path, bool& batch_mode, BatchOptions& batch, bool& help) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+
+        if (arg == "-h" || arg == "--help") {
+            help = true;
+            return true;
+        } else if (arg == "--heuristic" && has_value) {
+            std::string value = argv[++i];
+            if (value == "vsids") options.branching_heuristic = BranchingHeuristic::vsids;
+            else if (value == "frequency") options.branching_heuristic = BranchingHeuristic::frequency;
+            else {
+                std::cerr << "Error: Unknown heuristic " << value << "\n";
+                return false;
             }
-            if (literal_decision_level[lit_idx] == conflict_decision_level &&
-                literal_antecedent[lit_idx] != -1) {
-                resolver_literal_idx = lit_idx;
+        } else if (arg == "--var-decay" && has_value) {
+            options.variable_decay = std::stod(argv[++i]);
+            if (options.variable_decay <= 0.0 || options.variable_decay >= 1.0) {
+                std::cerr << "Error: --var-decay must be in (0, 1)\n";
+                return false;
             }
+        } else if (arg == "--no-phase-saving") {
+            options.phase_saving = false;
+        } else if (arg == "--restart" && has_value) {
+            std::string value = argv[++i];
+            if (value == "none") options.restart_strategy = RestartStrategy::none;
+            else if (value == "luby") options.restart_strategy = RestartStrategy::luby;
+            else if (value == "glucose") options.restart_strategy = RestartStrategy::glucose;
+            else {
+                std::cerr << "Error: Unknown restart policy " << value << "\n";
+                return false;
+            }
+        } else if (arg == "--luby-unit" && has_value) {
+            options.luby_unit = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--restart-margin" && has_value) {
+            options.restart_margin = std::stod(argv[++i]);
+        } else if (arg == "--restart-fast-alpha" && has_value) {
+            options.restart_fast_alpha = std::stod(argv[++i]);
+        } else if (arg == "--restart-slow-alpha" && has_value) {
+            options.restart_slow_alpha = std::stod(argv[++i]);
+        } else if (arg == "--restart-min-conflicts" && has_value) {
+            options.restart_min_conflicts = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--reduce-interval" && has_value) {
+            options.reduce_interval = std::max(0, std::stoi(argv[++i]));
+        } else if (arg == "--reduce-increment" && has_value) {
+            options.reduce_increment = std::max(0, std::stoi(argv[++i]));
+        } else if (arg == "--no-minimize") {
+            options.minimize_learnt = false;
+        } else if (arg == "--threads" && has_value) {
+            thread_count = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--share-lbd" && has_value) {
+            options.share_max_lbd = std::max(0, std::stoi(argv[++i]));
+        } else if (arg == "--cube-depth" && has_value) {
+            options.cube_depth = std::max(0, std::stoi(argv[++i]));
+        } else if (arg == "--cube-conflicts" && has_value) {
+            options.cube_conflicts = std::max(1LL, std::stoll(argv[++i]));
+        } else if (arg == "--sls" && has_value) {
+            sls_flips = std::max(0LL, std::stoll(argv[++i]));
+        } else if (arg == "--seed" && has_value) {
+            options.seed = (unsigned)std::stoul(argv[++i]);
+        } else if (arg == "--polarity" && has_value) {
+            std::string value = argv[++i];
+            if (value == "occurrence") options.initial_polarity = PolarityMode::occurrence;
+            else if (value == "positive") options.initial_polarity = PolarityMode::positive;
+            else if (value == "negative") options.initial_polarity = PolarityMode::negative;
+            else if (value == "random") options.initial_polarity = PolarityMode::random;
+            else {
+                std::cerr << "Error: Unknown polarity " << value << "\n";
+                return false;
+            }
+        } else if (arg == "--no-2sat") {
+            use_two_sat = false;
+        } else if (arg == "--preprocess") {
+            preprocess = true;
+        } else if (arg == "--stats") {
+            print_stats = true;
+            options.time_phases = true;
+        } else if (arg == "--progress" && has_value) {
+            options.progress_interval = std::max(0.0, std::stod(argv[++i]));
+        } else if (parse_budget_option(argc, argv, i, search_budgets, options.limits)) {
+            continue;
+        } else if (arg == "--proof" && has_value) {
+            proof_path = argv[++i];
+        } else if (arg == "--batch") {
+            batch_mode = true;
+        } else if (arg == "--socket" && has_value) {
+            batch_mode = true;
+            batch.socket_path = argv[++i];
+        } else if (arg == "--workers" && has_value) {
+            batch.workers = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--completion-order") {
+            batch.completion_order = true;
+        } else if (arg.size() > 1 && arg[0] == '-' && arg != "-") {
+            std::cerr << "Error: Unknown option " << arg << "\n";
+            return false;
+        } else {
+            filename = arg;
         }
-        
-        if (this_level_count == 1) break;
-        
-        learnt_clause = resolve(learnt_clause, resolver_literal_idx);
-    } while (true);
-
-    literal_list_per_clause.push_back(learnt_clause);
-    
-    for (int variable : learnt_clause) {
-        int lit_idx = literal_to_variable_index(variable);
-        int update = (variable > 0) ? 1 : -1;
-        literal_polarity[lit_idx] += update;
-        
-        if (literal_frequency[lit_idx] != -1) {
-            literal_frequency[lit_idx]++;
-        }
-        original_literal_frequency[lit_idx]++;
     }
-    
-    clause_count++;
-
-    int backtracked_decision_level = 0;
-    for (int variable : learnt_clause) {
-        int lit_idx = literal_to_variable_index(variable);
-        int level_here = literal_decision_level[lit_idx];
-        
-        if (level_here != conflict_decision_level && level_here > backtracked_decision_level) {
-            backtracked_decision_level = level_here;
-        }
+    return !filename.empty() || batch_mode;
+}
+
+int main(int argc, char* argv[]) {
+    SolverOptions options;
+    std::string filename;
+    bool print_stats = false;
+    bool use_two_sat = true;
+    bool preprocess = false;
+    int thread_count = 1;
+    long long sls_flips = 0;
+    std::string proof_path;
+    bool batch_mode = false;
+    BatchOptions batch;
+    bool help = false;
+    bool parsed = parse_arguments(argc, argv, options, filename, print_stats, use_two_sat, preprocess, thread_count,
+                                  sls_flips, proof_path, batch_mode, batch, help);
+    if (help || !parsed) {
+        print_usage();
+        return help ? 0 : 1;
     }
 
-    for (size_t i = 0; i < literals.size(); i++) {
-        if (literal_decision_level[i] > backtracked_decision_level) {
-            unassign_literal((int)i);
+    if (batch_mode) {
+        if (!filename.empty() || !proof_path.empty() || thread_count > 1 || options.cube_depth > 0 ||
+            sls_flips > 0) {
+            std::cerr << "Error: batch mode takes no input file and cannot be combined with --proof, --threads,\n"
+                      << "       --cube-depth or --sls\n";
+            return 1;
         }
+        // Progress lines would interleave with the responses.
+        options.progress_interval = 0.0;
+        options.time_phases = false;
+        std::string error;
+        bool served = run_batch(batch, [&]() -> std::unique_ptr<BatchWorker> {
+            return std::make_unique<CDCLBatchWorker>(options, use_two_sat, preprocess);
+        }, error);
+        if (!served) std::cerr << "Error: " << error << "\n";
+        return served ? 0 : 1;
+    }
+    // Shared clauses, cubes and the preprocessor's renumbering all leave
+    // steps a checker could not follow from the input formula.
+    if (!proof_path.empty() && (thread_count > 1 || options.cube_depth > 0 || preprocess)) {
+        std::cerr << "Error: --proof cannot be combined with --threads, --cube-depth or --preprocess\n";
+        return 1;
     }
 
-    return backtracked_decision_level;
-}
+    DimacsFormula formula;
+    std::string error;
+    if (!read_dimacs(filename, formula, error)) {
+        std::cerr << "Error: " << error << "\n";
+        return 1;
+    }
 
-std::vector<int>& SATSolverCDCL::resolve(std::vector<int>& input_clause, int literal_idx) {
-    std::vector<int> second_input = literal_list_per_clause[literal_antecedent[literal_idx]];
-    
-    input_clause.insert(input_clause.end(), second_input.begin(), second_input.end());
-    
-    int var_num = literal_idx + 1;
-    
-    for (int i = 0; i < (int)input_clause.size(); i++) {
-        if (input_clause[i] == var_num || input_clause[i] == -var_num) {
-            input_clause.erase(input_clause.begin() + i);
-            i--;
+    Preprocessor preprocessor;
+    if (preprocess) {
+        DimacsFormula reduced;
+        if (!preprocessor.run(formula, reduced)) {
+            std::cout << "UNSAT in " << preprocessor.stats().milliseconds << " ms\n";
+            report_preprocess(preprocessor.stats());
+            report_load(formula.load_stats);
+            return 0;
         }
+        formula = std::move(reduced);
     }
-    
-    std::sort(input_clause.begin(), input_clause.end());
-    input_clause.erase(std::unique(input_clause.begin(), input_clause.end()), input_clause.end());
-    
-    return input_clause;
-}
 
-int SATSolverCDCL::pick_branching_variable() {
-    std::uniform_int_distribution<int> choose_branch(1, 10);
-    std::uniform_int_distribution<int> choose_literal(0, literal_count - 1);
-    
-    if (pick_counter > 20 * literal_count) {
-        for (size_t i = 0; i < literals.size(); i++) {
-            original_literal_frequency[i] /= 2;
-            if (literal_frequency[i] != -1) literal_frequency[i] /= 2;
-        }
-        pick_counter = 0;
+    if (use_two_sat && proof_path.empty() && is_two_sat(formula)) {
+        std::vector<int> model;
+        auto start = std::chrono::high_resolution_clock::now();
+        bool sat = solve_two_sat(formula, model);
+        auto end = std::chrono::high_resolution_clock::now();
+
+        double ms = std::chrono::duration<double, std::milli>(end - start).count();
+        std::cout << (sat ? "SAT" : "UNSAT") << " in " << ms << " ms\n";
+        std::cout << "c solved by the 2-SAT implication graph engine\n";
+        if (preprocess) report_preprocess(preprocessor.stats());
+        report_load(formula.load_stats);
+        return 0;
     }
-    
-    int variable_idx = -1;
-    int max_freq = -1;
-    
-    for (int i = 0; i < literal_count; i++) {
-        if (literal_frequency[i] > max_freq) {
-            max_freq = literal_frequency[i];
-            variable_idx = i;
+
+    // Hybrid mode: local search either finds a model outright or leaves its
+    // best assignment as the starting phases of the complete search.
+    std::vector<int> phases;
+    SLSStats sls_stats;
+    double sls_ms = 0.0;
+    if (sls_flips > 0) {
+        SLSOptions sls_options;
+        sls_options.max_flips = sls_flips;
+        if (options.seed != 0) sls_options.seed = options.seed;
+        sls_options.limits.timeout_seconds = options.limits.timeout_seconds;
+        sls_options.limits.max_memory_bytes = options.limits.max_memory_bytes;
+
+        auto start = std::chrono::high_resolution_clock::now();
+        SLSSolver sls(formula, sls_options);
+        bool sat = sls.solve();
+        auto end = std::chrono::high_resolution_clock::now();
+        sls_ms = std::chrono::duration<double, std::milli>(end - start).count();
+        sls_stats = sls.stats();
+
+        if (sat) {
+            std::cout << "SAT in " << sls_ms << " ms\n";
+            std::cout << "c solved by local search after " << sls_stats.flips << " flips\n";
+            if (preprocess) report_preprocess(preprocessor.stats());
+            report_load(formula.load_stats);
+            return 0;
+        }
+        if (sls.budget_exceeded() != BudgetLimit::none) {
+            std::cout << "UNKNOWN in " << sls_ms << " ms\n";
+            std::cout << "c local search: " << sls_stats.flips << " flips, best " << sls_stats.best_unsatisfied
+                      << " unsatisfied clauses\n";
+            report_budget(sls.budget_exceeded());
+            if (preprocess) report_preprocess(preprocessor.stats());
+            report_load(formula.load_stats);
+            return 0;
+        }
+        phases = sls.best_assignment();
+        // The complete search gets what is left of the time limit.
+        if (options.limits.timeout_seconds > 0.0) {
+            options.limits.timeout_seconds = std::max(1e-6, options.limits.timeout_seconds - sls_ms / 1000.0);
         }
     }
-    
-    if (variable_idx != -1) {
-        pick_counter++;
-        return (literal_polarity[variable_idx] >= 0) ? variable_idx + 1 : -variable_idx - 1;
+    auto report_sls = [&]() {
+        if (sls_flips == 0) return;
+        std::cout << "c local search: " << sls_stats.flips << " flips in " << sls_ms << " ms, best "
+                  << sls_stats.best_unsatisfied << " unsatisfied clauses seeded the phases\n";
+    };
+
+    if (options.cube_depth > 0) {
+        auto start = std::chrono::high_resolution_clock::now();
+        CubeAndConquerResult cube_result = solve_cube_and_conquer(formula, options, thread_count, phases);
+        auto end = std::chrono::high_resolution_clock::now();
+
+        double ms = sls_ms + std::chrono::duration<double, std::milli>(end - start).count();
+        std::string outcome = (cube_result.result == RetVal::r_satisfied) ? "SAT"
+                            : (cube_result.result == RetVal::r_unsatisfied) ? "UNSAT" : "UNKNOWN";
+        std::cout << outcome << " in " << ms << " ms\n";
+        std::cout << "c cube-and-conquer: " << thread_count << " workers, " << cube_result.initial_cubes
+                  << " cubes, " << cube_result.splits << " splits, " << cube_result.steals << " steals\n";
+        report_sls();
+        if (preprocess) report_preprocess(preprocessor.stats());
+        report_load(formula.load_stats);
+        if (cube_result.exceeded != BudgetLimit::none) report_budget(cube_result.exceeded);
+
+        if (print_stats) report_search_stats(cube_result.total_stats, ms * thread_count);
+        return 0;
     }
 
-    bool too_many_attempts = false;
-    int attempt_counter = 0;
-    do {
-        int idx = choose_literal(generator);
-        if (literal_frequency[idx] != -1) {
-             return (literal_polarity[idx] >= 0) ? idx + 1 : -idx - 1;
+    if (thread_count > 1) {
+        auto start = std::chrono::high_resolution_clock::now();
+        PortfolioResult portfolio = solve_portfolio(formula, options, thread_count, phases);
+        auto end = std::chrono::high_resolution_clock::now();
+
+        double ms = sls_ms + std::chrono::duration<double, std::milli>(end - start).count();
+        std::string outcome = (portfolio.result == RetVal::r_satisfied) ? "SAT"
+                            : (portfolio.result == RetVal::r_unsatisfied) ? "UNSAT" : "UNKNOWN";
+        std::cout << outcome << " in " << ms << " ms\n";
+        if (portfolio.winner != -1) {
+            std::cout << "c portfolio: " << thread_count << " workers, answer from worker " << portfolio.winner << "\n";
+        } else {
+            std::cout << "c portfolio: " << thread_count << " workers, no answer\n";
         }
-        attempt_counter++;
-        if (attempt_counter > 10 * literal_count) too_many_attempts = true;
-    } while (!too_many_attempts);
-
-    return 1;
-}
-
-bool SATSolverCDCL::all_variables_assigned() {
-    return literal_count == assigned_literal_count;
-}
-
-int SATSolverCDCL::CDCL() {
-    int decision_level = 0;
-    if (already_unsatisfied) return RetVal::r_unsatisfied;
-    
-    int unit_propagate_result = unit_propagate(decision_level);
-    if (unit_propagate_result == RetVal::r_unsatisfied) return unit_propagate_result;
-
-    while (!all_variables_assigned()) {
-        int picked_variable = pick_branching_variable();
-        decision_level++;
-        assign_literal(picked_variable, decision_level, -1);
-        
-        while (true) {
-            unit_propagate_result = unit_propagate(decision_level);
-            if (unit_propagate_result == RetVal::r_unsatisfied) {
-                if (decision_level == 0) return RetVal::r_unsatisfied;
-                decision_level = conflict_analysis_and_backtrack(decision_level);
-            } else {
-                break;
-            }
+        report_sls();
+        if (preprocess) report_preprocess(preprocessor.stats());
+        report_load(formula.load_stats);
+        if (portfolio.exceeded != BudgetLimit::none) report_budget(portfolio.exceeded);
+
+        if (print_stats) {
+            const SolverStats& stats = portfolio.winner_stats;
+            report_search_stats(stats, ms);
+            std::cout << "c shared clauses: " << stats.exported_clauses << " exported, "
+                      << stats.imported_clauses << " imported\n";
         }
+        return 0;
     }
-    return RetVal::r_satisfied;
-}
 
-int SATSolverCDCL::solve() {
-    return CDCL();
-}
-
-int main(int argc, char* argv[]) {
-    if (argc < 2) {
-        std::cerr << "Usage: ./cdcl_solver <input_file.cnf>\n";
+    DratWriter proof;
+    if (!proof_path.empty() && !proof.open(proof_path, error)) {
+        std::cerr << "Error: " << error << "\n";
         return 1;
     }
-    std::string filename = argv[1];
 
-    SATSolverCDCL solver;
-    solver.initialize(filename);
+    SATSolverCDCL solver(options);
+    if (proof.is_open()) solver.set_proof(&proof);
+    solver.initialize(formula);
+    solver.set_phases(phases);
 
     auto start = std::chrono::high_resolution_clock::now();
     int result = solver.solve();
+    bool proof_written = proof.close();
     auto end = std::chrono::high_resolution_clock::now();
 
-    double ms = std::chrono::duration<double, std::milli>(end - start).count();
-    std::string outcome = (result == RetVal::r_satisfied ? "SAT" : "UNSAT");
+    double ms = sls_ms + std::chrono::duration<double, std::milli>(end - start).count();
+    std::string outcome = (result == RetVal::r_satisfied) ? "SAT"
+                        : (result == RetVal::r_unsatisfied) ? "UNSAT" : "UNKNOWN";
     
     std::cout << outcome << " in " << ms << " ms\n";
+    report_sls();
+    if (preprocess) report_preprocess(preprocessor.stats());
+    report_load(solver.get_load_stats());
+    if (result == RetVal::r_unknown) report_budget(solver.get_budget().exceeded());
+    if (!proof_path.empty()) {
+        if (!proof_written) std::cerr << "Error: writing the proof to " << proof_path << " failed\n";
+        report_proof(proof.stats());
+    }
+
+    if (print_stats) {
+        const SolverStats& stats = solver.get_stats();
+        report_search_stats(stats, ms - sls_ms);
+        std::cout << "c reductions: " << stats.reductions << " (" << stats.deleted_clauses << " clauses deleted)\n"
+                  << "c garbage collections: " << stats.garbage_collections << "\n"
+                  << "c clause arena: " << solver.clause_memory_bytes() / 1024 << " KB\n";
+    }
     
-    return 0;
-}
\ No newline at end of file
+    return proof_written ? 0 : 1;
+}
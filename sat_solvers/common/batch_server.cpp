@@ -0,0 +1,370 @@
+#include "batch_server.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Reads up to size bytes; returns 0 at end of stream and -1 on error.
+using ByteSource = std::function<long long(char*, size_t)>;
+using LineSink = std::function<void(const std::string&)>;
+
+using Clock = std::chrono::steady_clock;
+
+double milliseconds_between(Clock::time_point start, Clock::time_point end) {
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// Splits a byte stream into request lines and the raw DIMACS blocks that
+// follow @cnf lines.
+class RequestReader {
+private:
+    ByteSource source;
+    std::vector<char> buffer;
+    size_t head = 0;
+    bool finished = false;
+
+    bool fill() {
+        if (finished) return false;
+        buffer.erase(buffer.begin(), buffer.begin() + head);
+        head = 0;
+        size_t used = buffer.size();
+        buffer.resize(used + (1 << 16));
+        long long got = source(buffer.data() + used, 1 << 16);
+        buffer.resize(used + (size_t)std::max(0LL, got));
+        if (got <= 0) finished = true;
+        return got > 0;
+    }
+
+public:
+    explicit RequestReader(ByteSource source) : source(std::move(source)) {}
+
+    bool read_line(std::string& line) {
+        line.clear();
+        while (true) {
+            auto begin = buffer.begin() + head;
+            auto newline = std::find(begin, buffer.end(), '\n');
+            line.append(begin, newline);
+            head = (size_t)(newline - buffer.begin());
+            if (newline != buffer.end()) {
+                head++;
+                break;
+            }
+            if (!fill()) {
+                if (line.empty()) return false;
+                break;
+            }
+        }
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        return true;
+    }
+
+    bool read_exact(size_t count, std::string& bytes) {
+        bytes.clear();
+        while (bytes.size() < count) {
+            if (head == buffer.size() && !fill()) return false;
+            size_t take = std::min(count - bytes.size(), buffer.size() - head);
+            bytes.append(buffer.data() + head, take);
+            head += take;
+        }
+        return true;
+    }
+};
+
+// Collects the response lines of one request stream. In input order a line
+// waits until every earlier index has been written.
+class BatchOutput {
+private:
+    std::mutex mutex;
+    std::condition_variable idle;
+    LineSink sink;
+    bool completion_order;
+    long long submitted = 0;
+    long long delivered = 0;
+    long long next_index = 0;
+    std::map<long long, std::string> waiting;
+    std::map<std::string, long long> answers;
+
+public:
+    BatchOutput(LineSink sink, bool completion_order) : sink(std::move(sink)), completion_order(completion_order) {}
+
+    void expect() {
+        std::lock_guard<std::mutex> lock(mutex);
+        submitted++;
+    }
+
+    void deliver(long long index, const std::string& answer, std::string line) {
+        std::lock_guard<std::mutex> lock(mutex);
+        answers[answer]++;
+        if (completion_order) {
+            sink(line);
+        } else {
+            waiting.emplace(index, std::move(line));
+            for (auto it = waiting.begin(); it != waiting.end() && it->first == next_index; it = waiting.erase(it)) {
+                sink(it->second);
+                next_index++;
+            }
+        }
+        if (++delivered == submitted) idle.notify_all();
+    }
+
+    void wait_idle() {
+        std::unique_lock<std::mutex> lock(mutex);
+        idle.wait(lock, [this]() { return delivered == submitted; });
+    }
+
+    void summarize(int workers, double ms) {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::ostringstream line;
+        line << "c batch: " << delivered << " instances (" << answers["SAT"] << " SAT, " << answers["UNSAT"]
+             << " UNSAT, " << answers["UNKNOWN"] << " UNKNOWN, " << answers["ERROR"] << " errors) on " << workers
+             << " workers in " << ms << " ms";
+        sink(line.str());
+    }
+};
+
+struct Job {
+    long long index = 0;
+    std::string path;
+    std::string text;
+    bool inline_text = false;
+    BatchOutput* output = nullptr;
+};
+
+// Bounded so that a fast producer cannot buffer a whole stream of inline
+// formulas in memory ahead of the workers.
+class JobQueue {
+private:
+    std::mutex mutex;
+    std::condition_variable not_empty;
+    std::condition_variable not_full;
+    std::deque<Job> jobs;
+    size_t capacity;
+    bool closed = false;
+
+public:
+    explicit JobQueue(size_t capacity) : capacity(capacity) {}
+
+    void push(Job job) {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_full.wait(lock, [this]() { return jobs.size() < capacity; });
+        jobs.push_back(std::move(job));
+        lock.unlock();
+        not_empty.notify_one();
+    }
+
+    bool pop(Job& job) {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_empty.wait(lock, [this]() { return !jobs.empty() || closed; });
+        if (jobs.empty()) return false;
+        job = std::move(jobs.front());
+        jobs.pop_front();
+        lock.unlock();
+        not_full.notify_one();
+        return true;
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        not_empty.notify_all();
+    }
+};
+
+void run_worker(JobQueue& queue, const BatchWorkerFactory& make_worker) {
+    std::unique_ptr<BatchWorker> worker = make_worker();
+    DimacsFormula formula;
+    std::string error;
+    Job job;
+    while (queue.pop(job)) {
+        std::ostringstream line;
+        line << job.index << ' ' << (job.inline_text ? "-" : job.path) << ' ';
+
+        auto start = Clock::now();
+        bool parsed = job.inline_text ? parse_dimacs(job.text.data(), job.text.size(), formula, error)
+                                      : read_dimacs(job.path, formula, error);
+        // A worker sizes its arrays from the formula, so anything it could
+        // index past is answered with ERROR here rather than crashing the
+        // whole server.
+        if (parsed) parsed = validate_formula(formula, error);
+        auto parsed_at = Clock::now();
+        if (!parsed) {
+            line << "ERROR " << error;
+            job.output->deliver(job.index, "ERROR", line.str());
+            continue;
+        }
+        const char* answer = worker->solve(formula);
+        auto end = Clock::now();
+        line << answer << " in " << milliseconds_between(parsed_at, end) << " ms (parse "
+             << milliseconds_between(start, parsed_at) << " ms)";
+        job.output->deliver(job.index, answer, line.str());
+    }
+}
+
+// Reads requests until the stream ends or asks to quit, and returns once
+// every response has been written. Returns true on @quit.
+bool serve_stream(RequestReader& reader, BatchOutput& output, JobQueue& queue, int workers) {
+    auto start = Clock::now();
+    bool quit = false;
+    long long index = 0;
+    std::string line;
+    while (reader.read_line(line)) {
+        if (line.empty()) continue;
+        Job job;
+        job.index = index;
+        job.output = &output;
+
+        std::string failure;
+        if (line == "@quit") {
+            quit = true;
+            break;
+        } else if (line.compare(0, 5, "@cnf ") == 0) {
+            char* end = nullptr;
+            unsigned long long size = std::strtoull(line.c_str() + 5, &end, 10);
+            if (end == line.c_str() + 5 || *end != '\0') {
+                failure = "malformed request " + line;
+            } else if (!reader.read_exact((size_t)size, job.text)) {
+                failure = "stream ended inside an inline formula";
+            }
+            job.inline_text = true;
+        } else if (line[0] == '@') {
+            failure = "unknown request " + line;
+        } else if (line == "-") {
+            failure = "standard input carries the requests, not a formula";
+        } else {
+            job.path = line;
+        }
+
+        output.expect();
+        if (failure.empty()) {
+            queue.push(std::move(job));
+        } else {
+            output.deliver(index, "ERROR",
+                           std::to_string(index) + ' ' + (job.inline_text ? "-" : line) + " ERROR " + failure);
+        }
+        index++;
+        if (job.inline_text && !failure.empty()) break;
+    }
+    output.wait_idle();
+    output.summarize(workers, milliseconds_between(start, Clock::now()));
+    return quit;
+}
+
+bool serve_stdin(JobQueue& queue, const BatchOptions& options, int workers) {
+    RequestReader reader([](char* data, size_t size) -> long long {
+        size_t got = std::fread(data, 1, size, stdin);
+        return (got == 0 && std::ferror(stdin)) ? -1 : (long long)got;
+    });
+    BatchOutput output([](const std::string& line) {
+        std::fwrite(line.data(), 1, line.size(), stdout);
+        std::fputc('\n', stdout);
+        std::fflush(stdout);
+    }, options.completion_order);
+    serve_stream(reader, output, queue, workers);
+    return true;
+}
+
+#ifndef _WIN32
+bool serve_socket(JobQueue& queue, const BatchOptions& options, int workers, std::string& error) {
+    sockaddr_un address{};
+    if (options.socket_path.size() >= sizeof(address.sun_path)) {
+        error = "Socket path too long: " + options.socket_path;
+        return false;
+    }
+    address.sun_family = AF_UNIX;
+    std::strcpy(address.sun_path, options.socket_path.c_str());
+
+    // A socket left behind by an earlier server is replaced; any other file
+    // at the path is not.
+    struct stat existing;
+    if (stat(options.socket_path.c_str(), &existing) == 0 && S_ISSOCK(existing.st_mode)) {
+        unlink(options.socket_path.c_str());
+    }
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0 || bind(listener, (sockaddr*)&address, sizeof(address)) != 0 || listen(listener, 16) != 0) {
+        error = "Cannot listen on " + options.socket_path + ": " + std::strerror(errno);
+        if (listener >= 0) close(listener);
+        return false;
+    }
+
+    bool quit = false;
+    while (!quit) {
+        int connection = accept(listener, nullptr, nullptr);
+        if (connection < 0) {
+            if (errno == EINTR) continue;
+            error = std::string("accept failed: ") + std::strerror(errno);
+            break;
+        }
+        RequestReader reader([connection](char* data, size_t size) -> long long {
+            ssize_t got;
+            do got = recv(connection, data, size, 0); while (got < 0 && errno == EINTR);
+            return got;
+        });
+        BatchOutput output([connection](const std::string& line) {
+            std::string framed = line + '\n';
+            int flags = 0;
+#ifdef MSG_NOSIGNAL
+            flags = MSG_NOSIGNAL;
+#endif
+            // A client that hung up just loses the rest of its responses.
+            for (size_t sent = 0; sent < framed.size();) {
+                ssize_t n = send(connection, framed.data() + sent, framed.size() - sent, flags);
+                if (n < 0 && errno == EINTR) continue;
+                if (n <= 0) break;
+                sent += (size_t)n;
+            }
+        }, options.completion_order);
+        quit = serve_stream(reader, output, queue, workers);
+        close(connection);
+    }
+    close(listener);
+    unlink(options.socket_path.c_str());
+    return error.empty();
+}
+#endif
+
+}  // namespace
+
+bool run_batch(const BatchOptions& options, const BatchWorkerFactory& make_worker, std::string& error) {
+#ifdef _WIN32
+    if (!options.socket_path.empty()) {
+        error = "Unix sockets are not supported on this platform";
+        return false;
+    }
+#endif
+    int workers = options.workers > 0 ? options.workers : (int)std::max(1u, std::thread::hardware_concurrency());
+    JobQueue queue(4 * (size_t)workers);
+    std::vector<std::thread> pool;
+    for (int i = 0; i < workers; i++) pool.emplace_back(run_worker, std::ref(queue), std::cref(make_worker));
+
+    bool served = true;
+    if (options.socket_path.empty()) {
+        served = serve_stdin(queue, options, workers);
+    } else {
+#ifndef _WIN32
+        served = serve_socket(queue, options, workers, error);
+#endif
+    }
+
+    queue.close();
+    for (std::thread& thread : pool) thread.join();
+    return served;
+}
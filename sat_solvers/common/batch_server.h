@@ -0,0 +1,42 @@
+#pragma once
+
+#include "dimacs_reader.h"
+
+#include <functional>
+#include <memory>
+#include <string>
+
+// One solver per pool thread, kept for the whole batch so that its clause
+// storage and random generator are set up once, not once per instance.
+class BatchWorker {
+public:
+    virtual ~BatchWorker() = default;
+    // Returns "SAT", "UNSAT" or "UNKNOWN".
+    virtual const char* solve(const DimacsFormula& formula) = 0;
+};
+
+// Called once on every pool thread.
+using BatchWorkerFactory = std::function<std::unique_ptr<BatchWorker>()>;
+
+struct BatchOptions {
+    // Pool size; 0 uses one thread per hardware thread.
+    int workers = 0;
+    // Stream results as instances finish instead of in input order.
+    bool completion_order = false;
+    // Listen on this Unix socket instead of serving standard input.
+    std::string socket_path;
+};
+
+// Long-running batch mode. Requests are read one per line:
+//   <path>          solve the DIMACS file at path
+//   @cnf <bytes>    solve the DIMACS text in the <bytes> bytes that follow
+//   @quit           stop the server once this connection is done
+// and every instance gets one response line, numbered from 0 in request
+// order:
+//   <index> <path or -> SAT|UNSAT|UNKNOWN in <ms> ms (parse <ms> ms)
+//   <index> <path or -> ERROR <message>
+// followed at the end of the stream by "c batch: ..." totals. Files are read
+// and parsed on the pool threads, so only request framing is sequential.
+// On a socket, connections are served one after another until @quit.
+// Returns false with error set if the server could not start.
+bool run_batch(const BatchOptions& options, const BatchWorkerFactory& make_worker, std::string& error);
@@ -0,0 +1,138 @@
+#include "budget.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+
+namespace {
+
+std::atomic<size_t> live_bytes{0};
+std::atomic<size_t> peak_bytes{0};
+
+// Every block carries its size in a header that keeps the pointer handed
+// out aligned like malloc's.
+constexpr size_t header_bytes = alignof(std::max_align_t);
+
+void* tracked_allocate(size_t size) {
+    if (size > SIZE_MAX - header_bytes) throw std::bad_alloc();
+    void* raw;
+    while ((raw = std::malloc(size + header_bytes)) == nullptr) {
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) throw std::bad_alloc();
+        handler();
+    }
+    *static_cast<size_t*>(raw) = size;
+
+    size_t now = live_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+    size_t peak = peak_bytes.load(std::memory_order_relaxed);
+    while (now > peak && !peak_bytes.compare_exchange_weak(peak, now, std::memory_order_relaxed)) {
+    }
+    return static_cast<char*>(raw) + header_bytes;
+}
+
+void* tracked_allocate_nothrow(size_t size) noexcept {
+    try {
+        return tracked_allocate(size);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void tracked_free(void* pointer) noexcept {
+    if (!pointer) return;
+    char* raw = static_cast<char*>(pointer) - header_bytes;
+    live_bytes.fetch_sub(*reinterpret_cast<size_t*>(raw), std::memory_order_relaxed);
+    std::free(raw);
+}
+
+}  // namespace
+
+// Over-aligned allocations keep the library's own operators and go untracked.
+void* operator new(size_t size) { return tracked_allocate(size); }
+void* operator new[](size_t size) { return tracked_allocate(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return tracked_allocate_nothrow(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return tracked_allocate_nothrow(size); }
+void operator delete(void* pointer) noexcept { tracked_free(pointer); }
+void operator delete[](void* pointer) noexcept { tracked_free(pointer); }
+void operator delete(void* pointer, size_t) noexcept { tracked_free(pointer); }
+void operator delete[](void* pointer, size_t) noexcept { tracked_free(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { tracked_free(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { tracked_free(pointer); }
+
+size_t tracked_memory_bytes() {
+    return live_bytes.load(std::memory_order_relaxed);
+}
+
+size_t peak_tracked_memory_bytes() {
+    return peak_bytes.load(std::memory_order_relaxed);
+}
+
+const char* budget_limit_name(BudgetLimit limit) {
+    switch (limit) {
+        case BudgetLimit::none: return "none";
+        case BudgetLimit::timeout: return "timeout";
+        case BudgetLimit::conflicts: return "conflict limit";
+        case BudgetLimit::decisions: return "decision limit";
+        case BudgetLimit::resolvents: return "resolvent limit";
+        case BudgetLimit::memory: return "memory limit";
+        case BudgetLimit::clause_arena: return "clause arena full";
+    }
+    return "unknown";
+}
+
+void Budget::start(const BudgetLimits& budget_limits) {
+    limits = budget_limits;
+    calls = 0;
+    hit = BudgetLimit::none;
+    deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                                      std::chrono::duration<double>(limits.timeout_seconds));
+}
+
+bool Budget::check_clock_and_memory() {
+    if (limits.timeout_seconds > 0.0 && std::chrono::steady_clock::now() >= deadline) {
+        hit = BudgetLimit::timeout;
+    } else if (limits.max_memory_bytes > 0 && tracked_memory_bytes() > limits.max_memory_bytes) {
+        hit = BudgetLimit::memory;
+    }
+    return hit != BudgetLimit::none;
+}
+
+bool parse_budget_option(int argc, char* argv[], int& i, unsigned options, BudgetLimits& limits) {
+    if (i + 1 >= argc) return false;
+    std::string arg = argv[i];
+    if (arg == "--timeout" && (options & budget_timeout)) {
+        limits.timeout_seconds = std::max(0.0, std::stod(argv[i + 1]));
+    } else if (arg == "--max-conflicts" && (options & budget_conflicts)) {
+        limits.max_conflicts = std::max(0LL, std::stoll(argv[i + 1]));
+    } else if (arg == "--max-decisions" && (options & budget_decisions)) {
+        limits.max_decisions = std::max(0LL, std::stoll(argv[i + 1]));
+    } else if (arg == "--max-resolvents" && (options & budget_resolvents)) {
+        limits.max_resolvents = std::max(0LL, std::stoll(argv[i + 1]));
+    } else if (arg == "--max-memory" && (options & budget_memory)) {
+        limits.max_memory_bytes = (size_t)(std::max(0.0, std::stod(argv[i + 1])) * 1048576.0);
+    } else {
+        return false;
+    }
+    i++;
+    return true;
+}
+
+void print_budget_usage(std::ostream& out, unsigned options) {
+    out << "Budgets (0 is unlimited; a run that exceeds one ends with UNKNOWN):\n";
+    if (options & budget_timeout) out << "  --timeout <seconds>            Wall-clock limit\n";
+    if (options & budget_conflicts) out << "  --max-conflicts <n>            Conflict limit\n";
+    if (options & budget_decisions) out << "  --max-decisions <n>            Decision limit\n";
+    if (options & budget_resolvents) out << "  --max-resolvents <n>           Resolvent limit\n";
+    if (options & budget_memory) out << "  --max-memory <MB>              Heap limit, counted by the allocator\n";
+}
+
+void report_budget(BudgetLimit limit) {
+    std::cout << "c budget exhausted: " << budget_limit_name(limit) << " (peak heap " << std::fixed
+              << std::setprecision(1) << peak_tracked_memory_bytes() / 1048576.0 << " MB)\n" << std::defaultfloat
+              << std::setprecision(6);
+}
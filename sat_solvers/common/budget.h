@@ -0,0 +1,97 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <iosfwd>
+
+// Heap bytes currently held through operator new. The counting operator
+// new and delete live in budget.cpp and replace the global ones in every
+// program that links the budget library.
+size_t tracked_memory_bytes();
+size_t peak_tracked_memory_bytes();
+
+// Resource limits for one run; 0 means unlimited. Engines only look at the
+// counters they have: conflicts and decisions for the search solvers,
+// resolvents for DP and resolution.
+struct BudgetLimits {
+    double timeout_seconds = 0.0;
+    long long max_conflicts = 0;
+    long long max_decisions = 0;
+    long long max_resolvents = 0;
+    size_t max_memory_bytes = 0;
+};
+
+enum class BudgetLimit {
+    none,
+    timeout,
+    conflicts,
+    decisions,
+    resolvents,
+    memory,
+    // Set by an engine whose own storage ran out of addressable room.
+    clause_arena
+};
+
+const char* budget_limit_name(BudgetLimit limit);
+
+// Cooperative budget checked from the engines' main loops. The counter
+// limits cost a compare per call; the clock and the memory meter are read
+// only every 256 calls. Once a limit is hit, exhausted() keeps returning
+// true and exceeded() names it, so the engine can unwind and report UNKNOWN.
+class Budget {
+private:
+    BudgetLimits limits;
+    std::chrono::steady_clock::time_point deadline;
+    unsigned calls = 0;
+    BudgetLimit hit = BudgetLimit::none;
+
+    bool check_clock_and_memory();
+
+public:
+    // Starts the clock: the timeout counts from here.
+    void start(const BudgetLimits& budget_limits);
+
+    bool exhausted(long long conflicts, long long decisions, long long resolvents) {
+        if (hit != BudgetLimit::none) return true;
+        if (limits.max_conflicts > 0 && conflicts >= limits.max_conflicts) hit = BudgetLimit::conflicts;
+        else if (limits.max_decisions > 0 && decisions >= limits.max_decisions) hit = BudgetLimit::decisions;
+        else if (limits.max_resolvents > 0 && resolvents >= limits.max_resolvents) hit = BudgetLimit::resolvents;
+        else if ((++calls & 255) != 0) return false;
+        else return check_clock_and_memory();
+        return true;
+    }
+
+    // Ends the run as if limit had been hit, for limits the engine checks
+    // itself. A limit already hit is kept.
+    void stop(BudgetLimit limit) {
+        if (hit == BudgetLimit::none) hit = limit;
+    }
+
+    BudgetLimit exceeded() const { return hit; }
+    const BudgetLimits& get_limits() const { return limits; }
+};
+
+// The limits an engine checks, as a mask of BudgetOptions. Each binary
+// accepts and lists only its own.
+enum BudgetOptions : unsigned {
+    budget_timeout = 1u << 0,
+    budget_conflicts = 1u << 1,
+    budget_decisions = 1u << 2,
+    budget_resolvents = 1u << 3,
+    budget_memory = 1u << 4,
+
+    search_budgets = budget_timeout | budget_conflicts | budget_decisions | budget_memory,  // CDCL, DPLL
+    resolution_budgets = budget_timeout | budget_resolvents | budget_memory,                // DP, resolution
+    local_search_budgets = budget_timeout | budget_memory  // flips have their own option
+};
+
+// Consumes argv[i] (and its value) if it is one of --timeout <seconds>,
+// --max-conflicts <n>, --max-decisions <n>, --max-resolvents <n> or
+// --max-memory <MB> and options includes it.
+bool parse_budget_option(int argc, char* argv[], int& i, unsigned options, BudgetLimits& limits);
+
+// The usage lines for the options in the mask.
+void print_budget_usage(std::ostream& out, unsigned options);
+
+// Prints "c budget exhausted: <limit>" with the peak tracked memory.
+void report_budget(BudgetLimit limit);
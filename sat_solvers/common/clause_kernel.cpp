@@ -0,0 +1,306 @@
+#include "clause_kernel.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CLAUSE_KERNEL_SSE2 1
+#include <emmintrin.h>
+#endif
+
+// GCC and Clang compile the AVX2 path for every x86 build and pick it at run
+// time; other compilers only have it when the whole build targets AVX2.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CLAUSE_KERNEL_AVX2 1
+#define CLAUSE_KERNEL_AVX2_TARGET __attribute__((target("avx2")))
+#include <immintrin.h>
+#elif defined(__AVX2__)
+#define CLAUSE_KERNEL_AVX2 1
+#define CLAUSE_KERNEL_AVX2_TARGET
+#include <immintrin.h>
+#endif
+
+namespace {
+
+inline uint8_t status_of(int satisfied, int false_count, int width) {
+    if (satisfied) return CLAUSE_SATISFIED;
+    if (false_count == width) return CLAUSE_CONFLICT;
+    if (false_count == width - 1) return CLAUSE_UNIT;
+    return CLAUSE_UNRESOLVED;
+}
+
+inline void count_status(ClassifyCounts& counts, uint8_t status) {
+    switch (status) {
+        case CLAUSE_SATISFIED: counts.satisfied++; break;
+        case CLAUSE_UNIT: counts.unit++; break;
+        case CLAUSE_CONFLICT: counts.conflict++; break;
+        default: counts.unresolved++; break;
+    }
+}
+
+#ifdef CLAUSE_KERNEL_SSE2
+// Four clauses per step. SSE2 has no gather, so the four values of each
+// column are loaded one by one and everything after that is vector code.
+template <int K>
+ClassifyCounts sse2_kernel(const int32_t* values, const int32_t* const* columns, size_t n, uint8_t* status) {
+    const __m128i one = _mm_set1_epi32(1);
+    const __m128i two = _mm_set1_epi32(2);
+    const __m128i three = _mm_set1_epi32(3);
+    const __m128i width = _mm_set1_epi32(K);
+    const __m128i width_minus_one = _mm_set1_epi32(K - 1);
+    __m128i satisfied_total = _mm_setzero_si128();
+    __m128i unit_total = _mm_setzero_si128();
+    __m128i conflict_total = _mm_setzero_si128();
+
+    size_t c = 0;
+    for (; c + 4 <= n; c += 4) {
+        __m128i satisfied = _mm_setzero_si128();
+        __m128i false_count = _mm_setzero_si128();
+        for (int j = 0; j < K; j++) {
+            const int32_t* column = columns[j] + c;
+            __m128i v = _mm_set_epi32(values[column[3]], values[column[2]], values[column[1]], values[column[0]]);
+            satisfied = _mm_or_si128(satisfied, _mm_cmpeq_epi32(v, one));
+            false_count = _mm_sub_epi32(false_count, _mm_cmpeq_epi32(v, two));
+        }
+        __m128i conflict = _mm_andnot_si128(satisfied, _mm_cmpeq_epi32(false_count, width));
+        __m128i unit = _mm_andnot_si128(satisfied, _mm_cmpeq_epi32(false_count, width_minus_one));
+        __m128i result = _mm_or_si128(_mm_and_si128(conflict, three), _mm_and_si128(unit, two));
+        result = _mm_or_si128(result, _mm_and_si128(satisfied, one));
+
+        __m128i packed = _mm_packs_epi32(result, result);
+        packed = _mm_packus_epi16(packed, packed);
+        int32_t bytes = _mm_cvtsi128_si32(packed);
+        std::memcpy(status + c, &bytes, 4);
+
+        satisfied_total = _mm_sub_epi32(satisfied_total, satisfied);
+        unit_total = _mm_sub_epi32(unit_total, unit);
+        conflict_total = _mm_sub_epi32(conflict_total, conflict);
+    }
+
+    alignas(16) int32_t lanes[3][4];
+    _mm_store_si128((__m128i*)lanes[0], satisfied_total);
+    _mm_store_si128((__m128i*)lanes[1], unit_total);
+    _mm_store_si128((__m128i*)lanes[2], conflict_total);
+    ClassifyCounts counts;
+    for (int lane = 0; lane < 4; lane++) {
+        counts.satisfied += lanes[0][lane];
+        counts.unit += lanes[1][lane];
+        counts.conflict += lanes[2][lane];
+    }
+    counts.unresolved = c - counts.satisfied - counts.unit - counts.conflict;
+    return counts;
+}
+#endif
+
+#ifdef CLAUSE_KERNEL_AVX2
+// Eight clauses per step, each column fetched with one 32-bit gather.
+template <int K>
+CLAUSE_KERNEL_AVX2_TARGET
+ClassifyCounts avx2_kernel(const int32_t* values, const int32_t* const* columns, size_t n, uint8_t* status) {
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i two = _mm256_set1_epi32(2);
+    const __m256i three = _mm256_set1_epi32(3);
+    const __m256i width = _mm256_set1_epi32(K);
+    const __m256i width_minus_one = _mm256_set1_epi32(K - 1);
+    __m256i satisfied_total = _mm256_setzero_si256();
+    __m256i unit_total = _mm256_setzero_si256();
+    __m256i conflict_total = _mm256_setzero_si256();
+
+    size_t c = 0;
+    for (; c + 8 <= n; c += 8) {
+        __m256i satisfied = _mm256_setzero_si256();
+        __m256i false_count = _mm256_setzero_si256();
+        for (int j = 0; j < K; j++) {
+            __m256i index = _mm256_loadu_si256((const __m256i*)(columns[j] + c));
+            __m256i v = _mm256_i32gather_epi32((const int*)values, index, 4);
+            satisfied = _mm256_or_si256(satisfied, _mm256_cmpeq_epi32(v, one));
+            false_count = _mm256_sub_epi32(false_count, _mm256_cmpeq_epi32(v, two));
+        }
+        __m256i conflict = _mm256_andnot_si256(satisfied, _mm256_cmpeq_epi32(false_count, width));
+        __m256i unit = _mm256_andnot_si256(satisfied, _mm256_cmpeq_epi32(false_count, width_minus_one));
+        __m256i result = _mm256_or_si256(_mm256_and_si256(conflict, three), _mm256_and_si256(unit, two));
+        result = _mm256_or_si256(result, _mm256_and_si256(satisfied, one));
+
+        // The 256-bit packs work per 128-bit lane, so narrow the halves with
+        // the 128-bit ones instead.
+        __m128i packed = _mm_packs_epi32(_mm256_castsi256_si128(result), _mm256_extracti128_si256(result, 1));
+        packed = _mm_packus_epi16(packed, packed);
+        _mm_storel_epi64((__m128i*)(status + c), packed);
+
+        satisfied_total = _mm256_sub_epi32(satisfied_total, satisfied);
+        unit_total = _mm256_sub_epi32(unit_total, unit);
+        conflict_total = _mm256_sub_epi32(conflict_total, conflict);
+    }
+
+    alignas(32) int32_t lanes[3][8];
+    _mm256_store_si256((__m256i*)lanes[0], satisfied_total);
+    _mm256_store_si256((__m256i*)lanes[1], unit_total);
+    _mm256_store_si256((__m256i*)lanes[2], conflict_total);
+    ClassifyCounts counts;
+    for (int lane = 0; lane < 8; lane++) {
+        counts.satisfied += lanes[0][lane];
+        counts.unit += lanes[1][lane];
+        counts.conflict += lanes[2][lane];
+    }
+    counts.unresolved = c - counts.satisfied - counts.unit - counts.conflict;
+    return counts;
+}
+#endif
+
+void add_counts(ClassifyCounts& total, const ClassifyCounts& part) {
+    total.satisfied += part.satisfied;
+    total.unit += part.unit;
+    total.conflict += part.conflict;
+    total.unresolved += part.unresolved;
+}
+
+} // namespace
+
+KernelIsa best_kernel_isa() {
+#if defined(CLAUSE_KERNEL_AVX2) && defined(__GNUC__)
+    if (__builtin_cpu_supports("avx2")) return KernelIsa::avx2;
+#elif defined(CLAUSE_KERNEL_AVX2)
+    return KernelIsa::avx2;
+#endif
+#ifdef CLAUSE_KERNEL_SSE2
+    return KernelIsa::sse2;
+#else
+    return KernelIsa::scalar;
+#endif
+}
+
+const char* kernel_isa_name(KernelIsa isa) {
+    switch (isa) {
+        case KernelIsa::avx2: return "avx2";
+        case KernelIsa::sse2: return "sse2";
+        default: return "scalar";
+    }
+}
+
+namespace {
+
+// A repeated literal would be counted twice by the kernel, so clauses are
+// sorted and deduplicated before anything else looks at them.
+void distinct_literals(const int* begin, const int* end, std::vector<int>& clause) {
+    clause.assign(begin, end);
+    normalize_clause(clause);
+}
+
+}  // namespace
+
+size_t max_clause_width(const DimacsFormula& formula) {
+    size_t width = 0;
+    std::vector<int> clause;
+    for (size_t i = 0; i < formula.clause_count(); ++i) {
+        distinct_literals(formula.clause_begin(i), formula.clause_end(i), clause);
+        width = std::max(width, clause.size());
+    }
+    return width;
+}
+
+template <int K>
+bool ClauseKernel<K>::load(const DimacsFormula& formula, std::string& error) {
+    const int32_t padding = 2 * formula.variable_count;
+    values.assign((size_t)padding + 1, value_free);
+    values[padding] = value_false;
+    for (std::vector<int32_t>& column : columns) {
+        column.clear();
+        column.reserve(formula.clause_count());
+    }
+
+    std::vector<int> clause;
+    for (size_t i = 0; i < formula.clause_count(); ++i) {
+        distinct_literals(formula.clause_begin(i), formula.clause_end(i), clause);
+        if (clause.size() > (size_t)K) {
+            for (std::vector<int32_t>& column : columns) column.clear();
+            error = "Clause " + std::to_string(i + 1) + " has " + std::to_string(clause.size()) +
+                    " distinct literals, more than the kernel's " + std::to_string(K);
+            return false;
+        }
+        for (int j = 0; j < K; j++) {
+            columns[j].push_back(j < (int)clause.size() ? lit_idx(clause[j]) : padding);
+        }
+    }
+    return true;
+}
+
+template <int K>
+void ClauseKernel<K>::assign(int lit) {
+    int index = lit_idx(lit);
+    values[index] = value_true;
+    values[index ^ 1] = value_false;
+}
+
+template <int K>
+void ClauseKernel<K>::unassign(int var) {
+    values[2 * (var - 1)] = value_free;
+    values[2 * (var - 1) + 1] = value_free;
+}
+
+template <int K>
+void ClauseKernel<K>::set_assignment(const std::vector<int>& model) {
+    const size_t variables = (values.size() - 1) / 2;
+    for (size_t v = 0; v < variables; v++) {
+        int value = v < model.size() ? model[v] : -1;
+        values[2 * v] = (value == 1) ? value_true : (value == 0) ? value_false : value_free;
+        values[2 * v + 1] = (value == 1) ? value_false : (value == 0) ? value_true : value_free;
+    }
+}
+
+template <int K>
+ClassifyCounts ClauseKernel<K>::classify_scalar(size_t begin, uint8_t* status) const {
+    ClassifyCounts counts;
+    for (size_t c = begin; c < clause_count(); c++) {
+        int satisfied = 0;
+        int false_count = 0;
+        for (int j = 0; j < K; j++) {
+            int32_t v = values[columns[j][c]];
+            satisfied |= (v == value_true);
+            false_count += (v == value_false);
+        }
+        status[c] = status_of(satisfied, false_count, K);
+        count_status(counts, status[c]);
+    }
+    return counts;
+}
+
+template <int K>
+ClassifyCounts ClauseKernel<K>::classify_sse2(uint8_t* status) const {
+#ifdef CLAUSE_KERNEL_SSE2
+    const int32_t* column_data[K];
+    for (int j = 0; j < K; j++) column_data[j] = columns[j].data();
+    ClassifyCounts counts = sse2_kernel<K>(values.data(), column_data, clause_count(), status);
+    add_counts(counts, classify_scalar(clause_count() & ~(size_t)3, status));
+    return counts;
+#else
+    return classify_scalar(0, status);
+#endif
+}
+
+template <int K>
+ClassifyCounts ClauseKernel<K>::classify_avx2(uint8_t* status) const {
+#ifdef CLAUSE_KERNEL_AVX2
+    const int32_t* column_data[K];
+    for (int j = 0; j < K; j++) column_data[j] = columns[j].data();
+    ClassifyCounts counts = avx2_kernel<K>(values.data(), column_data, clause_count(), status);
+    add_counts(counts, classify_scalar(clause_count() & ~(size_t)7, status));
+    return counts;
+#else
+    return classify_sse2(status);
+#endif
+}
+
+template <int K>
+ClassifyCounts ClauseKernel<K>::classify(uint8_t* status, KernelIsa isa) const {
+    isa = std::min(isa, best_kernel_isa());
+    switch (isa) {
+        case KernelIsa::avx2: return classify_avx2(status);
+        case KernelIsa::sse2: return classify_sse2(status);
+        default: return classify_scalar(0, status);
+    }
+}
+
+template class ClauseKernel<1>;
+template class ClauseKernel<2>;
+template class ClauseKernel<3>;
+template class ClauseKernel<4>;
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "dimacs_reader.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Per-clause result of ClauseKernel::classify.
+enum ClauseStatus : uint8_t {
+    CLAUSE_UNRESOLVED = 0,
+    CLAUSE_SATISFIED = 1,
+    CLAUSE_UNIT = 2,
+    CLAUSE_CONFLICT = 3
+};
+
+enum class KernelIsa { scalar, sse2, avx2 };
+
+// The widest instruction set both this build and the running CPU support.
+KernelIsa best_kernel_isa();
+const char* kernel_isa_name(KernelIsa isa);
+
+struct ClassifyCounts {
+    size_t satisfied = 0;
+    size_t unit = 0;
+    size_t conflict = 0;
+    size_t unresolved = 0;
+};
+
+// Bulk evaluation of a formula whose clauses have at most K <= 4 literals
+// under a partial assignment. Clauses are stored structure-of-arrays: column
+// j holds the literal index (2v or 2v + 1, as lit_idx) of the j-th literal
+// of every clause, so the vector paths load one literal of 8 (AVX2) or 4
+// (SSE2) clauses at a time and gather their values from a per-literal table.
+// Shorter clauses are padded with a slot that is always false, which keeps
+// every clause exactly K wide without changing its status.
+template <int K>
+class ClauseKernel {
+    static_assert(K >= 1 && K <= 4, "ClauseKernel is specialised for clauses of up to 4 literals");
+
+public:
+    // Loads the formula, counting a repeated literal once. Returns false
+    // with error set, and holds no clauses, if a clause has more than K
+    // distinct literals.
+    bool load(const DimacsFormula& formula, std::string& error);
+
+    void assign(int lit);
+    void unassign(int var);
+    // model[v] is 0 or 1 for variable v + 1; any other value leaves it free.
+    void set_assignment(const std::vector<int>& model);
+
+    // Writes one ClauseStatus per clause, in input order, to status.
+    ClassifyCounts classify(uint8_t* status, KernelIsa isa = best_kernel_isa()) const;
+
+    size_t clause_count() const { return columns[0].size(); }
+
+private:
+    enum : int32_t { value_free = 0, value_true = 1, value_false = 2 };
+
+    // values[2v] and values[2v + 1] for variable v + 1, then the padding slot.
+    std::vector<int32_t> values;
+    std::vector<int32_t> columns[K];
+
+    ClassifyCounts classify_scalar(size_t begin, uint8_t* status) const;
+    ClassifyCounts classify_sse2(uint8_t* status) const;
+    ClassifyCounts classify_avx2(uint8_t* status) const;
+};
+
+// Number of distinct literals in the widest clause, the smallest K that
+// ClauseKernel<K>::load accepts.
+size_t max_clause_width(const DimacsFormula& formula);
+
+extern template class ClauseKernel<1>;
+extern template class ClauseKernel<2>;
+extern template class ClauseKernel<3>;
+extern template class ClauseKernel<4>;
@@ -0,0 +1,332 @@
+#include "dimacs_reader.h"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Owns the bytes of the input: a read-only mapping of the file when
+// possible, otherwise a heap buffer filled by plain reads.
+class InputBuffer {
+private:
+    std::vector<char> buffer;
+    const char* mapped = nullptr;
+    size_t mapped_size = 0;
+
+public:
+    InputBuffer() = default;
+    InputBuffer(const InputBuffer&) = delete;
+    InputBuffer& operator=(const InputBuffer&) = delete;
+    ~InputBuffer() {
+#ifndef _WIN32
+        if (mapped) munmap(const_cast<char*>(mapped), mapped_size);
+#endif
+    }
+
+    bool load_stdin();
+    bool load_file(const std::string& path);
+
+    const char* begin() const { return mapped ? mapped : buffer.data(); }
+    const char* end() const { return begin() + size(); }
+    size_t size() const { return mapped ? mapped_size : buffer.size(); }
+};
+
+bool InputBuffer::load_stdin() {
+#ifdef _WIN32
+    _setmode(_fileno(stdin), _O_BINARY);
+#endif
+    char chunk[1 << 16];
+    size_t read_bytes;
+    while ((read_bytes = std::fread(chunk, 1, sizeof(chunk), stdin)) > 0) {
+        buffer.insert(buffer.end(), chunk, chunk + read_bytes);
+    }
+    return !std::ferror(stdin);
+}
+
+bool InputBuffer::load_file(const std::string& path) {
+#ifndef _WIN32
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) == 0 && S_ISREG(file_stat.st_mode) && file_stat.st_size > 0) {
+        void* address = mmap(nullptr, (size_t)file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (address != MAP_FAILED) {
+            madvise(address, (size_t)file_stat.st_size, MADV_SEQUENTIAL);
+            mapped = static_cast<const char*>(address);
+            mapped_size = (size_t)file_stat.st_size;
+            close(fd);
+            return true;
+        }
+    }
+    close(fd);
+#endif
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return false;
+    buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+}
+
+class DimacsScanner {
+private:
+    const char* cursor;
+    const char* end;
+    int line = 1;
+
+public:
+    DimacsScanner(const char* begin, const char* end) : cursor(begin), end(end) {}
+
+    int line_number() const { return line; }
+    bool at_end() const { return cursor == end; }
+    size_t remaining() const { return (size_t)(end - cursor); }
+    char peek() const { return *cursor; }
+
+    void skip_whitespace() {
+        while (cursor != end && (*cursor == ' ' || *cursor == '\t' || *cursor == '\r' || *cursor == '\n')) {
+            if (*cursor == '\n') line++;
+            cursor++;
+        }
+    }
+
+    void skip_line() {
+        while (cursor != end && *cursor != '\n') cursor++;
+    }
+
+    bool scan_word(std::string& word) {
+        word.clear();
+        while (cursor != end && *cursor != ' ' && *cursor != '\t' && *cursor != '\r' && *cursor != '\n') {
+            word.push_back(*cursor++);
+        }
+        return !word.empty();
+    }
+
+    // Parses an optionally negative decimal integer that fits in an int.
+    bool scan_int(int& value) {
+        bool negative = false;
+        if (cursor != end && *cursor == '-') {
+            negative = true;
+            cursor++;
+        }
+        if (cursor == end || *cursor < '0' || *cursor > '9') return false;
+
+        long long magnitude = 0;
+        while (cursor != end && *cursor >= '0' && *cursor <= '9') {
+            magnitude = magnitude * 10 + (*cursor++ - '0');
+            if (magnitude > INT_MAX) return false;
+        }
+        value = negative ? -(int)magnitude : (int)magnitude;
+        return true;
+    }
+
+    void skip_blanks() {
+        while (cursor != end && (*cursor == ' ' || *cursor == '\t')) cursor++;
+    }
+};
+
+// Reads the problem line. The counts must not be negative; variables seen
+// before it still count, so variable_count only ever grows. The reserves are
+// capped by what the rest of the input can hold, as every literal and every
+// terminating 0 takes at least two bytes.
+bool parse_header(DimacsScanner& scanner, DimacsFormula& formula, std::string& error) {
+    std::string word;
+    scanner.scan_word(word);
+    scanner.skip_blanks();
+    scanner.scan_word(word);
+    scanner.skip_blanks();
+    int variables = -1;
+    int clauses = -1;
+    bool valid = word == "cnf" && scanner.scan_int(variables) && variables >= 0;
+    if (valid) {
+        scanner.skip_blanks();
+        valid = scanner.scan_int(clauses) && clauses >= 0;
+    }
+    if (!valid) {
+        error = "malformed problem line at line " + std::to_string(scanner.line_number());
+        return false;
+    }
+    formula.variable_count = std::max(formula.variable_count, variables);
+    formula.declared_clause_count = clauses;
+
+    const size_t tokens = scanner.remaining() / 2;
+    formula.literals.reserve(std::min((size_t)clauses * 3, tokens));
+    formula.clause_starts.reserve(std::min((size_t)clauses, tokens) + 1);
+    return true;
+}
+
+bool parse_body(DimacsScanner& scanner, DimacsFormula& formula, std::string& error) {
+    bool have_header = false;
+    bool clause_open = false;
+    while (true) {
+        scanner.skip_whitespace();
+        if (scanner.at_end()) break;
+
+        char next = scanner.peek();
+        if (next == 'c') {
+            scanner.skip_line();
+            continue;
+        }
+        if (next == 'p') {
+            if (have_header) {
+                error = "second problem line at line " + std::to_string(scanner.line_number());
+                return false;
+            }
+            if (!parse_header(scanner, formula, error)) return false;
+            have_header = true;
+            continue;
+        }
+        // SATLIB benchmark files end with "%" followed by junk.
+        if (next == '%') break;
+
+        int literal;
+        if (!scanner.scan_int(literal)) {
+            error = "unexpected character at line " + std::to_string(scanner.line_number());
+            return false;
+        }
+        if (literal == 0) {
+            formula.clause_starts.push_back((uint32_t)formula.literals.size());
+            clause_open = false;
+            continue;
+        }
+        formula.literals.push_back(literal);
+        int variable = literal > 0 ? literal : -literal;
+        if (variable > formula.variable_count) formula.variable_count = variable;
+        clause_open = true;
+    }
+
+    // Tolerate a final clause that is missing its terminating 0.
+    if (clause_open) formula.clause_starts.push_back((uint32_t)formula.literals.size());
+    return true;
+}
+
+void clear_formula(DimacsFormula& formula) {
+    formula.variable_count = 0;
+    formula.declared_clause_count = 0;
+    formula.literals.clear();
+    formula.clause_starts.assign(1, 0);
+    formula.load_stats = DimacsLoadStats();
+}
+
+}  // namespace
+
+bool read_dimacs(const std::string& path, DimacsFormula& formula, std::string& error) {
+    auto start = std::chrono::high_resolution_clock::now();
+
+    clear_formula(formula);
+    InputBuffer input;
+    bool loaded = (path == "-") ? input.load_stdin() : input.load_file(path);
+    if (!loaded) {
+        error = "Could not open file " + path;
+        return false;
+    }
+
+    DimacsScanner scanner(input.begin(), input.end());
+    if (!parse_body(scanner, formula, error)) return false;
+
+    auto end = std::chrono::high_resolution_clock::now();
+    formula.load_stats.bytes = input.size();
+    formula.load_stats.milliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+    return true;
+}
+
+bool parse_dimacs(const char* text, size_t size, DimacsFormula& formula, std::string& error) {
+    auto start = std::chrono::high_resolution_clock::now();
+
+    clear_formula(formula);
+    DimacsScanner scanner(text, text + size);
+    if (!parse_body(scanner, formula, error)) return false;
+
+    auto end = std::chrono::high_resolution_clock::now();
+    formula.load_stats.bytes = size;
+    formula.load_stats.milliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+    return true;
+}
+
+bool normalize_clause(std::vector<int>& clause) {
+    std::sort(clause.begin(), clause.end());
+    clause.erase(std::unique(clause.begin(), clause.end()), clause.end());
+    // Sorted, so a complementary pair has its positive half after the
+    // negative one.
+    for (size_t j = 0; j + 1 < clause.size() && clause[j] < 0; j++) {
+        if (std::binary_search(clause.begin() + j + 1, clause.end(), -clause[j])) return true;
+    }
+    return false;
+}
+
+void remove_duplicate_literals(DimacsFormula& formula) {
+    std::vector<int> literals;
+    std::vector<uint32_t> starts{0};
+    std::vector<int> clause;
+    literals.reserve(formula.literals.size());
+    starts.reserve(formula.clause_count() + 1);
+    for (size_t i = 0; i < formula.clause_count(); ++i) {
+        clause.assign(formula.clause_begin(i), formula.clause_end(i));
+        normalize_clause(clause);
+        literals.insert(literals.end(), clause.begin(), clause.end());
+        starts.push_back((uint32_t)literals.size());
+    }
+    formula.literals.swap(literals);
+    formula.clause_starts.swap(starts);
+}
+
+bool validate_formula(const DimacsFormula& formula, std::string& error) {
+    if (formula.variable_count < 0) {
+        error = "negative variable count";
+        return false;
+    }
+    if (formula.clause_starts.empty() || formula.clause_starts.front() != 0 ||
+        formula.clause_starts.back() != formula.literals.size() ||
+        !std::is_sorted(formula.clause_starts.begin(), formula.clause_starts.end())) {
+        error = "inconsistent clause offsets";
+        return false;
+    }
+    for (int literal : formula.literals) {
+        if (literal == 0 || literal == INT_MIN || std::abs(literal) > formula.variable_count) {
+            error = "literal " + std::to_string(literal) + " outside variables 1 to " +
+                    std::to_string(formula.variable_count);
+            return false;
+        }
+    }
+    return true;
+}
+
+void write_dimacs(std::ostream& out, const DimacsFormula& formula) {
+    std::string buffer = "p cnf " + std::to_string(formula.variable_count) + " " +
+                         std::to_string(formula.clause_count()) + "\n";
+    for (size_t i = 0; i < formula.clause_count(); ++i) {
+        for (const int* lit = formula.clause_begin(i); lit != formula.clause_end(i); ++lit) {
+            buffer += std::to_string(*lit);
+            buffer += ' ';
+        }
+        buffer += "0\n";
+        if (buffer.size() > (1 << 16)) {
+            out << buffer;
+            buffer.clear();
+        }
+    }
+    out << buffer;
+}
+
+void report_load(const DimacsLoadStats& stats) {
+    std::ostringstream line;
+    line << std::fixed << std::setprecision(3) << "c parsed " << stats.bytes / (1024.0 * 1024.0) << " MB in "
+         << stats.milliseconds << " ms (" << std::setprecision(1) << stats.megabytes_per_second() << " MB/s)\n";
+    std::cout << line.str();
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+struct DimacsLoadStats {
+    size_t bytes = 0;
+    double milliseconds = 0.0;
+
+    double megabytes_per_second() const {
+        return milliseconds > 0.0 ? (bytes / (1024.0 * 1024.0)) / (milliseconds / 1000.0) : 0.0;
+    }
+};
+
+// A CNF formula in compressed form: the literals of all clauses back to back,
+// with clause_starts[i] the offset of clause i and a final entry marking the
+// end. Empty clauses are kept, so callers can detect trivial UNSAT.
+struct DimacsFormula {
+    int variable_count = 0;
+    int declared_clause_count = 0;
+    std::vector<int> literals;
+    std::vector<uint32_t> clause_starts{0};
+    DimacsLoadStats load_stats;
+
+    size_t clause_count() const { return clause_starts.size() - 1; }
+    const int* clause_begin(size_t i) const { return literals.data() + clause_starts[i]; }
+    const int* clause_end(size_t i) const { return literals.data() + clause_starts[i + 1]; }
+    size_t clause_size(size_t i) const { return clause_starts[i + 1] - clause_starts[i]; }
+};
+
+// Literal l of variable v + 1 maps to 2 * v, its negation to 2 * v + 1:
+// the index into the per-literal arrays every engine keeps.
+inline int lit_idx(int lit) {
+    return (lit > 0) ? 2 * (lit - 1) : 2 * (-lit - 1) + 1;
+}
+
+// Sorts the clause and drops repeated literals. Returns true if what is
+// left is a tautology, holding both a literal and its negation.
+bool normalize_clause(std::vector<int>& clause);
+
+// normalize_clause on every clause of the formula, keeping tautologies.
+void remove_duplicate_literals(DimacsFormula& formula);
+
+// Reads a DIMACS CNF file, or standard input when path is "-". Files are
+// memory-mapped where the platform allows it and scanned in place. Clauses
+// may span lines and the header counts are advisory: variable_count is
+// raised to the largest variable seen. Returns false and fills error on
+// malformed input, a negative count or a second problem line, or on I/O
+// failure.
+bool read_dimacs(const std::string& path, DimacsFormula& formula, std::string& error);
+
+// Parses DIMACS CNF text already in memory, with the same rules. Both
+// readers reuse the formula's buffers, so a formula object that is parsed
+// into over and over stops allocating once it has seen the largest input.
+bool parse_dimacs(const char* text, size_t size, DimacsFormula& formula, std::string& error);
+
+// Checks what the engines rely on when they size arrays by variable_count:
+// the clause offsets are in order and in range, and every literal is
+// nonzero and names a variable up to variable_count. The readers above only
+// produce such formulas; formulas built by hand need not be.
+bool validate_formula(const DimacsFormula& formula, std::string& error);
+
+// Writes the formula as DIMACS CNF: a problem line, then one clause per line.
+void write_dimacs(std::ostream& out, const DimacsFormula& formula);
+
+// Prints "c parsed <size> MB in <time> ms (<rate> MB/s)" to standard output.
+void report_load(const DimacsLoadStats& stats);
@@ -0,0 +1,74 @@
+#include "drat_writer.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+bool DratWriter::open(const std::string& path, std::string& error) {
+    close();
+    file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        error = "Cannot open proof file " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    failed = false;
+    closing = false;
+    statistics = DratStats();
+    active.clear();
+    active.reserve(buffer_bytes + 64);
+    pending.clear();
+    pending.reserve(buffer_bytes + 64);
+    writer = std::thread(&DratWriter::run, this);
+    return true;
+}
+
+// Waits until the writer thread has finished the previous buffer, then
+// gives it the active one and carries on with the emptied spare.
+void DratWriter::hand_off() {
+    auto start = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(mutex);
+    drained.wait(lock, [this]() { return pending.empty(); });
+    statistics.bytes += active.size();
+    pending.swap(active);
+    lock.unlock();
+    ready.notify_one();
+    statistics.stall_milliseconds +=
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void DratWriter::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        ready.wait(lock, [this]() { return !pending.empty() || closing; });
+        if (pending.empty()) break;
+
+        // The solver never touches pending while it is non-empty, so the
+        // write itself can run unlocked.
+        lock.unlock();
+        if (!failed && std::fwrite(pending.data(), 1, pending.size(), file) != pending.size()) failed = true;
+        lock.lock();
+        pending.clear();
+        drained.notify_one();
+    }
+}
+
+bool DratWriter::close() {
+    if (!file) return !failed;
+    if (!active.empty()) hand_off();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        closing = true;
+    }
+    ready.notify_one();
+    writer.join();
+
+    if (std::fclose(file) != 0) failed = true;
+    file = nullptr;
+    return !failed;
+}
+
+void report_proof(const DratStats& stats) {
+    std::cout << "c proof: " << stats.additions << " additions, " << stats.deletions << " deletions, "
+              << stats.bytes << " bytes of binary DRAT, " << stats.stall_milliseconds << " ms waiting on the writer\n";
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct DratStats {
+    long long additions = 0;
+    long long deletions = 0;
+    uint64_t bytes = 0;
+    // Time the solver spent waiting for the writer thread to drain a buffer.
+    double stall_milliseconds = 0.0;
+};
+
+// Streams a clausal proof in binary DRAT: 'a' or 'd', then every literal as
+// a variable-length unsigned 2 * variable + sign (seven bits per byte, high
+// bit set on all but the last), then a zero byte. The solver encodes into
+// one buffer while a background thread writes the other, and the two swap
+// when the active one fills up, so the search only ever blocks if the disk
+// falls a whole buffer behind.
+class DratWriter {
+public:
+    explicit DratWriter(size_t buffer_bytes = (size_t)1 << 20) : buffer_bytes(buffer_bytes) {}
+    ~DratWriter() { close(); }
+    DratWriter(const DratWriter&) = delete;
+    DratWriter& operator=(const DratWriter&) = delete;
+
+    // Creates or truncates the proof file and starts the writer thread.
+    bool open(const std::string& path, std::string& error);
+    bool is_open() const { return file != nullptr; }
+
+    void add(const int* clause, size_t size) {
+        encode('a', clause, size);
+        statistics.additions++;
+    }
+    void remove(const int* clause, size_t size) {
+        encode('d', clause, size);
+        statistics.deletions++;
+    }
+
+    // Writes out what is buffered and stops the writer thread. Returns false
+    // if any write failed along the way.
+    bool close();
+
+    const DratStats& stats() const { return statistics; }
+
+private:
+    size_t buffer_bytes;
+    std::FILE* file = nullptr;
+    bool failed = false;
+    DratStats statistics;
+
+    // active is owned by the solver; pending by the writer thread while it
+    // is non-empty.
+    std::vector<uint8_t> active;
+    std::vector<uint8_t> pending;
+    bool closing = false;
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::condition_variable drained;
+    std::thread writer;
+
+    void encode(char tag, const int* clause, size_t size) {
+        if (!file) return;
+        active.push_back((uint8_t)tag);
+        for (size_t i = 0; i < size; i++) {
+            uint32_t value = 2u * (uint32_t)(clause[i] > 0 ? clause[i] : -clause[i]) + (clause[i] < 0 ? 1u : 0u);
+            while (value > 127) {
+                active.push_back((uint8_t)(value | 128));
+                value >>= 7;
+            }
+            active.push_back((uint8_t)value);
+        }
+        active.push_back(0);
+        if (active.size() >= buffer_bytes) hand_off();
+    }
+
+    void hand_off();
+    void run();
+};
+
+// Prints "c proof: ..." with the number of proof steps and bytes written.
+void report_proof(const DratStats& stats);
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+// Hot-path instrumentation shared by the solvers. Counters that only feed
+// --stats are updated through SAT_INSTRUMENT and phases are timed through
+// SAT_PHASE; both compile to nothing when the build sets
+// SAT_INSTRUMENTATION to 0 (cmake -DSAT_INSTRUMENTATION=OFF). Phase timers
+// also read the clock only when enabled at run time, so a run without
+// --stats pays one predictable branch per phase.
+
+#ifndef SAT_INSTRUMENTATION
+#define SAT_INSTRUMENTATION 1
+#endif
+
+enum SolverPhase {
+    phase_propagate,
+    phase_analyze,
+    phase_decide,
+    // Chronological backtracking, for solvers that learn nothing.
+    phase_backtrack,
+    phase_resolve,
+    phase_subsume,
+    phase_count
+};
+
+inline const char* phase_name(SolverPhase phase) {
+    static const char* const names[phase_count] = {"unit_propagate", "conflict_analysis_and_backtrack",
+                                                   "pick_branching_variable", "backtrack", "resolution",
+                                                   "subsumption"};
+    return names[phase];
+}
+
+struct PhaseTimes {
+    bool enabled = false;
+    double milliseconds[phase_count] = {};
+};
+
+class ScopedPhase {
+private:
+    PhaseTimes& times;
+    SolverPhase phase;
+    std::chrono::steady_clock::time_point start;
+
+public:
+    ScopedPhase(PhaseTimes& times, SolverPhase phase) : times(times), phase(phase) {
+        if (times.enabled) start = std::chrono::steady_clock::now();
+    }
+    ~ScopedPhase() {
+        if (!times.enabled) return;
+        times.milliseconds[phase] +=
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+    ScopedPhase(const ScopedPhase&) = delete;
+    ScopedPhase& operator=(const ScopedPhase&) = delete;
+};
+
+#if SAT_INSTRUMENTATION
+#define SAT_INSTRUMENT(statement) do { statement; } while (0)
+#define SAT_PHASE(times, phase) ScopedPhase sat_scoped_phase(times, phase)
+#else
+#define SAT_INSTRUMENT(statement) do { } while (0)
+#define SAT_PHASE(times, phase) do { } while (0)
+#endif
+
+// Decides when the next progress line is due. due() is meant for the
+// solvers' main loops: it only looks at the clock every 256 calls, and
+// never when no interval was set.
+class ProgressClock {
+private:
+    double interval_seconds = 0.0;
+    unsigned calls = 0;
+    std::chrono::steady_clock::time_point started;
+    std::chrono::steady_clock::time_point next;
+
+public:
+    void start(double interval) {
+        interval_seconds = interval;
+        calls = 0;
+        started = std::chrono::steady_clock::now();
+        next = started + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                             std::chrono::duration<double>(interval));
+    }
+
+    bool due() {
+        if (interval_seconds <= 0.0 || (++calls & 255) != 0) return false;
+        auto now = std::chrono::steady_clock::now();
+        if (now < next) return false;
+        next = now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                         std::chrono::duration<double>(interval_seconds));
+        return true;
+    }
+
+    double elapsed_seconds() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    }
+
+    // "c progress <seconds> s: ", formatted without touching the stream state.
+    std::string label() const {
+        char buffer[48];
+        std::snprintf(buffer, sizeof(buffer), "c progress %.1f s: ", elapsed_seconds());
+        return buffer;
+    }
+};
+
+// Prints "c time in <phase>: <ms> ms (<share>%)" for every phase that ran,
+// the share taken of total_ms.
+inline void report_phase_times(const PhaseTimes& times, double total_ms) {
+#if SAT_INSTRUMENTATION
+    for (int phase = 0; phase < phase_count; phase++) {
+        double ms = times.milliseconds[phase];
+        if (ms <= 0.0) continue;
+        std::streamsize precision = std::cout.precision();
+        std::cout << "c time in " << phase_name((SolverPhase)phase) << ": " << std::fixed << std::setprecision(3)
+                  << ms << " ms (" << std::setprecision(1) << (total_ms > 0.0 ? 100.0 * ms / total_ms : 0.0)
+                  << "%)\n" << std::defaultfloat << std::setprecision(precision);
+    }
+#else
+    (void)times;
+    (void)total_ms;
+    std::cout << "c phase timers compiled out (SAT_INSTRUMENTATION=0)\n";
+#endif
+}
@@ -0,0 +1,426 @@
+#include "preprocessor.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+
+namespace {
+
+// One bit per variable, folded into 64 bits. If C's signature has a bit
+// that D's lacks, C cannot be a subset of D even with one literal flipped.
+uint64_t variable_signature(const std::vector<int>& clause) {
+    uint64_t signature = 0;
+    for (int lit : clause) signature |= 1ull << ((std::abs(lit) - 1) & 63);
+    return signature;
+}
+
+uint64_t clause_hash(const std::vector<int>& clause) {
+    uint64_t hash = 1469598103934665603ull;
+    for (int lit : clause) {
+        hash ^= (uint32_t)lit;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// Clause set with per-literal occurrence lists and root-level assignments.
+// Unit clauses are never stored: they are assigned and propagated at once,
+// which deletes satisfied clauses and shortens the others.
+class Simplifier {
+public:
+    Simplifier(int variable_count, PreprocessStats& stats)
+        : occurrences(2 * (size_t)variable_count), value(variable_count, -1), mark(2 * (size_t)variable_count, 0),
+          stats(stats) {}
+
+    void add_clause(const std::vector<int>& clause);
+    bool propagate();
+    void remove_duplicates();
+    void subsume(bool strengthening);
+    void probe(long long budget);
+
+    bool inconsistent() const { return conflict; }
+    const std::vector<int>& values() const { return value; }
+
+    template <typename Visit>
+    void for_each_clause(Visit visit) const {
+        for (const Clause& clause : clauses) {
+            if (!clause.deleted) visit(clause.literals);
+        }
+    }
+
+private:
+    struct Clause {
+        std::vector<int> literals;
+        uint64_t signature;
+        bool deleted;
+    };
+
+    std::vector<Clause> clauses;
+    std::vector<std::vector<int>> occurrences;
+    std::vector<int> value;
+    std::vector<int> pending_units;
+    std::vector<int> mark;
+    int mark_stamp = 0;
+    bool conflict = false;
+    PreprocessStats& stats;
+
+    int literal_value(int lit) const {
+        int v = value[std::abs(lit) - 1];
+        if (v == -1) return -1;
+        return (lit > 0) ? v : 1 - v;
+    }
+
+    void assign_root(int lit);
+    void delete_clause(int c) { clauses[c].deleted = true; }
+    void remove_literal(int c, int lit);
+    int subsumption_check(const Clause& c, const Clause& d);
+    bool probe_conflicts(int lit, std::vector<int>& probe_trail, long long& budget);
+};
+
+void Simplifier::add_clause(const std::vector<int>& clause) {
+    if (clause.empty()) {
+        conflict = true;
+        return;
+    }
+    if (clause.size() == 1) {
+        assign_root(clause[0]);
+        return;
+    }
+    int c = (int)clauses.size();
+    clauses.push_back({clause, variable_signature(clause), false});
+    for (int lit : clause) occurrences[lit_idx(lit)].push_back(c);
+}
+
+void Simplifier::assign_root(int lit) {
+    int current = literal_value(lit);
+    if (current == 1) return;
+    if (current == 0) {
+        conflict = true;
+        return;
+    }
+    value[std::abs(lit) - 1] = (lit > 0) ? 1 : 0;
+    pending_units.push_back(lit);
+}
+
+void Simplifier::remove_literal(int c, int lit) {
+    std::vector<int>& literals = clauses[c].literals;
+    literals.erase(std::find(literals.begin(), literals.end(), lit));
+    clauses[c].signature = variable_signature(literals);
+
+    std::vector<int>& list = occurrences[lit_idx(lit)];
+    list.erase(std::find(list.begin(), list.end(), c));
+
+    if (literals.size() == 1) {
+        assign_root(literals[0]);
+        delete_clause(c);
+    }
+}
+
+// Applies the pending root assignments. Returns false on a conflict.
+bool Simplifier::propagate() {
+    while (!pending_units.empty() && !conflict) {
+        int lit = pending_units.back();
+        pending_units.pop_back();
+
+        for (int c : occurrences[lit_idx(lit)]) delete_clause(c);
+        occurrences[lit_idx(lit)].clear();
+
+        std::vector<int> shortened;
+        shortened.swap(occurrences[lit_idx(-lit)]);
+        for (int c : shortened) {
+            if (clauses[c].deleted) continue;
+            std::vector<int>& literals = clauses[c].literals;
+            literals.erase(std::find(literals.begin(), literals.end(), -lit));
+            clauses[c].signature = variable_signature(literals);
+            if (literals.empty()) conflict = true;
+            else if (literals.size() == 1) {
+                assign_root(literals[0]);
+                delete_clause(c);
+            }
+        }
+    }
+    return !conflict;
+}
+
+void Simplifier::remove_duplicates() {
+    std::unordered_map<uint64_t, std::vector<int>> store;
+    for (int c = 0; c < (int)clauses.size(); c++) {
+        if (clauses[c].deleted) continue;
+        std::vector<int>& bucket = store[clause_hash(clauses[c].literals)];
+        bool duplicate = false;
+        for (int other : bucket) {
+            if (clauses[other].literals == clauses[c].literals) {
+                duplicate = true;
+                break;
+            }
+        }
+        if (duplicate) {
+            delete_clause(c);
+            stats.duplicates++;
+        } else {
+            bucket.push_back(c);
+        }
+    }
+}
+
+// Returns 0 if c is a subset of d, the literal of d to remove if c is a
+// subset of d with exactly one literal flipped (self-subsumption), and
+// INT32_MIN otherwise.
+int Simplifier::subsumption_check(const Clause& c, const Clause& d) {
+    mark_stamp++;
+    for (int lit : d.literals) mark[lit_idx(lit)] = mark_stamp;
+
+    int flipped = 0;
+    for (int lit : c.literals) {
+        if (mark[lit_idx(lit)] == mark_stamp) continue;
+        if (flipped == 0 && mark[lit_idx(-lit)] == mark_stamp) {
+            flipped = -lit;
+            continue;
+        }
+        return INT32_MIN;
+    }
+    return flipped;
+}
+
+// Backward subsumption and self-subsuming strengthening, shortest clauses
+// first. A clause that gets strengthened is queued again since it may now
+// subsume others.
+void Simplifier::subsume(bool strengthening) {
+    std::vector<int> queue;
+    for (int c = 0; c < (int)clauses.size(); c++) {
+        if (!clauses[c].deleted) queue.push_back(c);
+    }
+    std::stable_sort(queue.begin(), queue.end(),
+                     [this](int a, int b) { return clauses[a].literals.size() < clauses[b].literals.size(); });
+
+    std::vector<int> candidates;
+    for (size_t head = 0; head < queue.size() && !conflict; head++) {
+        int c = queue[head];
+        if (clauses[c].deleted) continue;
+
+        // Every clause c can subsume or strengthen holds one of the two
+        // literals of each of c's variables; scan the least frequent.
+        int pivot = clauses[c].literals[0];
+        size_t best = SIZE_MAX;
+        for (int lit : clauses[c].literals) {
+            size_t count = occurrences[lit_idx(lit)].size() + (strengthening ? occurrences[lit_idx(-lit)].size() : 0);
+            if (count < best) {
+                best = count;
+                pivot = lit;
+            }
+        }
+        candidates = occurrences[lit_idx(pivot)];
+        if (strengthening) {
+            candidates.insert(candidates.end(), occurrences[lit_idx(-pivot)].begin(), occurrences[lit_idx(-pivot)].end());
+        }
+
+        for (int d : candidates) {
+            if (clauses[c].deleted) break;
+            if (d == c || clauses[d].deleted) continue;
+            if (clauses[d].literals.size() < clauses[c].literals.size()) continue;
+            if (clauses[c].signature & ~clauses[d].signature) continue;
+
+            int result = subsumption_check(clauses[c], clauses[d]);
+            if (result == 0) {
+                delete_clause(d);
+                stats.subsumed++;
+            } else if (result != INT32_MIN && strengthening) {
+                remove_literal(d, result);
+                stats.strengthened++;
+                if (!propagate()) return;
+                if (!clauses[d].deleted) queue.push_back(d);
+            }
+        }
+    }
+    for (std::vector<int>& list : occurrences) {
+        list.erase(std::remove_if(list.begin(), list.end(), [this](int c) { return clauses[c].deleted; }), list.end());
+    }
+}
+
+// Propagates lit on top of the root assignment. The literals it implies are
+// left on probe_trail for the caller to undo. Returns true on a conflict.
+bool Simplifier::probe_conflicts(int lit, std::vector<int>& probe_trail, long long& budget) {
+    value[std::abs(lit) - 1] = (lit > 0) ? 1 : 0;
+    probe_trail.push_back(lit);
+
+    for (size_t head = probe_trail.size() - 1; head < probe_trail.size(); head++) {
+        int falsified = -probe_trail[head];
+        for (int c : occurrences[lit_idx(falsified)]) {
+            if (clauses[c].deleted) continue;
+            budget--;
+
+            int unassigned = 0;
+            int last_free = 0;
+            bool satisfied = false;
+            for (int other : clauses[c].literals) {
+                int other_value = literal_value(other);
+                if (other_value == 1) {
+                    satisfied = true;
+                    break;
+                }
+                if (other_value == -1) {
+                    unassigned++;
+                    last_free = other;
+                }
+            }
+            if (satisfied || unassigned > 1) continue;
+            if (unassigned == 0) return true;
+
+            value[std::abs(last_free) - 1] = (last_free > 0) ? 1 : 0;
+            probe_trail.push_back(last_free);
+        }
+    }
+    return false;
+}
+
+// Failed literal probing: a literal whose propagation runs into a conflict
+// is false in every model, so its negation becomes a root unit.
+void Simplifier::probe(long long budget) {
+    std::vector<int> probe_trail;
+    for (int v = 0; v < (int)value.size() && budget > 0 && !conflict; v++) {
+        for (int lit : {v + 1, -v - 1}) {
+            if (value[v] != -1 || occurrences[lit_idx(-lit)].empty()) continue;
+
+            bool failed = probe_conflicts(lit, probe_trail, budget);
+            for (int assigned : probe_trail) value[std::abs(assigned) - 1] = -1;
+            probe_trail.clear();
+
+            if (failed) {
+                stats.failed_literals++;
+                assign_root(-lit);
+                if (!propagate()) return;
+            }
+        }
+    }
+}
+
+}  // namespace
+
+bool Preprocessor::run(const DimacsFormula& input, DimacsFormula& output) {
+    auto start = std::chrono::high_resolution_clock::now();
+    statistics = PreprocessStats();
+    fixed_value.clear();
+    reduced_variable.clear();
+    statistics.original_variables = input.variable_count;
+    statistics.original_clauses = input.clause_count();
+
+    Simplifier simplifier(input.variable_count, statistics);
+    std::vector<int> clause;
+    for (size_t i = 0; i < input.clause_count(); ++i) {
+        clause.assign(input.clause_begin(i), input.clause_end(i));
+        bool tautology = normalize_clause(clause);
+        if (tautology) {
+            statistics.tautologies++;
+            continue;
+        }
+        simplifier.add_clause(clause);
+    }
+
+    if (simplifier.propagate()) {
+        simplifier.remove_duplicates();
+        if (options.subsumption) simplifier.subsume(options.strengthening);
+        if (options.probing && !simplifier.inconsistent()) simplifier.probe(options.probe_budget);
+    }
+
+    output = DimacsFormula();
+    output.load_stats = input.load_stats;
+    bool satisfiable = !simplifier.inconsistent();
+    if (satisfiable) {
+        fixed_value = simplifier.values();
+        reduced_variable.assign(input.variable_count, 0);
+        int next_variable = 0;
+        simplifier.for_each_clause([&](const std::vector<int>& literals) {
+            for (int lit : literals) {
+                int& mapped = reduced_variable[std::abs(lit) - 1];
+                if (mapped == 0) mapped = ++next_variable;
+                output.literals.push_back(lit > 0 ? mapped : -mapped);
+            }
+            output.clause_starts.push_back((uint32_t)output.literals.size());
+        });
+        output.variable_count = next_variable;
+        output.declared_clause_count = (int)output.clause_count();
+        statistics.fixed_variables = std::count_if(fixed_value.begin(), fixed_value.end(), [](int v) { return v != -1; });
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    statistics.remaining_variables = output.variable_count;
+    statistics.remaining_clauses = output.clause_count();
+    statistics.milliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+    return satisfiable;
+}
+
+std::vector<int> Preprocessor::map_model(const std::vector<int>& reduced_model) const {
+    std::vector<int> model(fixed_value.size(), 0);
+    for (size_t v = 0; v < model.size(); v++) {
+        if (fixed_value[v] != -1) model[v] = fixed_value[v];
+        else if (reduced_variable[v] != 0 && (size_t)reduced_variable[v] <= reduced_model.size()) {
+            model[v] = reduced_model[reduced_variable[v] - 1];
+        }
+        // Variables left in no clause can take either value.
+    }
+    return model;
+}
+
+void Preprocessor::write_map(std::ostream& out) const {
+    std::string buffer = "c variables " + std::to_string(fixed_value.size()) + "\n";
+    for (size_t v = 0; v < fixed_value.size(); v++) {
+        if (fixed_value[v] != -1) {
+            buffer += "c fixed " + std::to_string(v + 1) + " " + std::to_string(fixed_value[v]) + "\n";
+        } else if (reduced_variable[v] != 0) {
+            buffer += "c map " + std::to_string(v + 1) + " " + std::to_string(reduced_variable[v]) + "\n";
+        }
+        if (buffer.size() > (1 << 16)) {
+            out << buffer;
+            buffer.clear();
+        }
+    }
+    out << buffer;
+}
+
+bool Preprocessor::read_map(std::istream& in, std::string& error) {
+    fixed_value.clear();
+    reduced_variable.clear();
+    bool have_count = false;
+    std::string line;
+    for (int line_number = 1; std::getline(in, line); line_number++) {
+        std::istringstream words(line);
+        std::string c, kind;
+        long long variable = 0, value = 0;
+        if (!(words >> c >> kind) || c != "c") continue;
+        if (kind == "variables" && words >> value && value >= 0) {
+            fixed_value.assign((size_t)value, -1);
+            reduced_variable.assign((size_t)value, 0);
+            have_count = true;
+            continue;
+        }
+        if (kind != "map" && kind != "fixed") continue;
+        if (!have_count || !(words >> variable >> value) || variable < 1 || variable > (long long)fixed_value.size() ||
+            (kind == "fixed" ? (value != 0 && value != 1) : value < 1)) {
+            error = "Malformed variable map at line " + std::to_string(line_number) + ": " + line;
+            return false;
+        }
+        if (kind == "fixed") fixed_value[variable - 1] = (int)value;
+        else reduced_variable[variable - 1] = (int)value;
+    }
+    if (!have_count) {
+        error = "Variable map has no \"c variables\" line";
+        return false;
+    }
+    return true;
+}
+
+void report_preprocess(const PreprocessStats& stats) {
+    std::ostringstream line;
+    line << std::fixed << std::setprecision(3) << "c preprocess: " << stats.original_variables << " -> "
+         << stats.remaining_variables << " variables, " << stats.original_clauses << " -> " << stats.remaining_clauses
+         << " clauses in " << stats.milliseconds << " ms (" << stats.tautologies << " tautologies, "
+         << stats.duplicates << " duplicates, " << stats.subsumed << " subsumed, " << stats.strengthened
+         << " strengthened, " << stats.failed_literals << " failed literals, " << stats.fixed_variables
+         << " fixed)\n";
+    std::cout << line.str();
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "dimacs_reader.h"
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+struct PreprocessOptions {
+    bool subsumption = true;
+    bool strengthening = true;
+    bool probing = true;
+    // Clause visits failed literal probing may spend in total.
+    long long probe_budget = 50000000;
+};
+
+struct PreprocessStats {
+    long long tautologies = 0;
+    long long duplicates = 0;
+    long long subsumed = 0;
+    long long strengthened = 0;
+    long long failed_literals = 0;
+    long long fixed_variables = 0;
+    int original_variables = 0;
+    int remaining_variables = 0;
+    size_t original_clauses = 0;
+    size_t remaining_clauses = 0;
+    double milliseconds = 0.0;
+};
+
+// Equivalence-preserving CNF simplification in front of any solver:
+// tautology and hash-based duplicate removal, subsumption and self-subsuming
+// strengthening filtered by 64-bit clause signatures, and failed literal
+// probing. Fixed variables are removed and the rest renumbered densely, so
+// the reduced formula is self-contained DIMACS.
+class Preprocessor {
+public:
+    explicit Preprocessor(const PreprocessOptions& options = PreprocessOptions()) : options(options) {}
+
+    // Writes the reduced formula to output. Returns false if the input was
+    // found unsatisfiable, in which case output is left empty.
+    bool run(const DimacsFormula& input, DimacsFormula& output);
+
+    // Turns a model of the reduced formula (0 or 1 per reduced variable)
+    // into one of the original formula, 0 or 1 per original variable.
+    // Reduced variables past the end of the model count as 0.
+    std::vector<int> map_model(const std::vector<int>& reduced_model) const;
+
+    // The renumbering and the fixed values of the last successful run, as
+    // DIMACS comment lines:
+    //   c variables <original count>
+    //   c map <original variable> <reduced variable>
+    //   c fixed <original variable> <0|1>
+    // Variables on no line occur in no clause and can take either value.
+    void write_map(std::ostream& out) const;
+    // Loads a map written by write_map, so that map_model works without
+    // running the preprocessor again.
+    bool read_map(std::istream& in, std::string& error);
+
+    const PreprocessStats& stats() const { return statistics; }
+
+private:
+    PreprocessOptions options;
+    PreprocessStats statistics;
+    // Per original variable: the reduced variable it became (0 if none) and
+    // the value it was fixed to (-1 if it was not).
+    std::vector<int> reduced_variable;
+    std::vector<int> fixed_value;
+};
+
+// Prints "c preprocess: ..." with what the preprocessor removed.
+void report_preprocess(const PreprocessStats& stats);
@@ -0,0 +1,134 @@
+#include "two_sat.h"
+
+#include <algorithm>
+
+namespace {
+
+// Node 2 * v is the positive literal of variable v + 1, node 2 * v + 1 the
+// negative one, so a literal's negation is node ^ 1.
+inline int literal_to_node(int literal) {
+    return (literal > 0) ? 2 * (literal - 1) : 2 * (-literal - 1) + 1;
+}
+
+struct ImplicationGraph {
+    std::vector<int> edge_starts;
+    std::vector<int> edges;
+
+    int node_count() const { return (int)edge_starts.size() - 1; }
+};
+
+// Clause (a or b) yields the implications -a -> b and -b -> a. A unit clause
+// (a) is treated as (a or a).
+ImplicationGraph build_implication_graph(const DimacsFormula& formula) {
+    int node_count = 2 * formula.variable_count;
+    ImplicationGraph graph;
+    graph.edge_starts.assign(node_count + 1, 0);
+
+    for (size_t i = 0; i < formula.clause_count(); ++i) {
+        const int* clause = formula.clause_begin(i);
+        int a = literal_to_node(clause[0]);
+        int b = (formula.clause_size(i) == 2) ? literal_to_node(clause[1]) : a;
+        graph.edge_starts[(a ^ 1) + 1]++;
+        graph.edge_starts[(b ^ 1) + 1]++;
+    }
+    for (int node = 0; node < node_count; ++node) graph.edge_starts[node + 1] += graph.edge_starts[node];
+
+    graph.edges.resize(graph.edge_starts[node_count]);
+    std::vector<int> fill(graph.edge_starts.begin(), graph.edge_starts.end() - 1);
+    for (size_t i = 0; i < formula.clause_count(); ++i) {
+        const int* clause = formula.clause_begin(i);
+        int a = literal_to_node(clause[0]);
+        int b = (formula.clause_size(i) == 2) ? literal_to_node(clause[1]) : a;
+        graph.edges[fill[a ^ 1]++] = b;
+        graph.edges[fill[b ^ 1]++] = a;
+    }
+    return graph;
+}
+
+// Iterative Tarjan. Components are numbered in the order they are completed,
+// which is a reverse topological order of the condensation.
+std::vector<int> strongly_connected_components(const ImplicationGraph& graph) {
+    int node_count = graph.node_count();
+    std::vector<int> component(node_count, -1);
+    std::vector<int> index(node_count, -1);
+    std::vector<int> lowlink(node_count, 0);
+    std::vector<int> next_edge(node_count, 0);
+    std::vector<int> scc_stack;
+    std::vector<int> call_stack;
+    scc_stack.reserve(node_count);
+    call_stack.reserve(node_count);
+
+    int next_index = 0;
+    int component_count = 0;
+
+    for (int root = 0; root < node_count; ++root) {
+        if (index[root] != -1) continue;
+
+        call_stack.push_back(root);
+        index[root] = lowlink[root] = next_index++;
+        next_edge[root] = graph.edge_starts[root];
+        scc_stack.push_back(root);
+
+        while (!call_stack.empty()) {
+            int node = call_stack.back();
+
+            if (next_edge[node] < graph.edge_starts[node + 1]) {
+                int successor = graph.edges[next_edge[node]++];
+                if (index[successor] == -1) {
+                    index[successor] = lowlink[successor] = next_index++;
+                    next_edge[successor] = graph.edge_starts[successor];
+                    scc_stack.push_back(successor);
+                    call_stack.push_back(successor);
+                } else if (component[successor] == -1) {
+                    lowlink[node] = std::min(lowlink[node], index[successor]);
+                }
+                continue;
+            }
+
+            call_stack.pop_back();
+            if (!call_stack.empty()) {
+                int parent = call_stack.back();
+                lowlink[parent] = std::min(lowlink[parent], lowlink[node]);
+            }
+            if (lowlink[node] == index[node]) {
+                int member;
+                do {
+                    member = scc_stack.back();
+                    scc_stack.pop_back();
+                    component[member] = component_count;
+                } while (member != node);
+                component_count++;
+            }
+        }
+    }
+    return component;
+}
+
+}  // namespace
+
+bool is_two_sat(const DimacsFormula& formula) {
+    for (size_t i = 0; i < formula.clause_count(); ++i) {
+        if (formula.clause_size(i) > 2) return false;
+    }
+    return true;
+}
+
+bool solve_two_sat(const DimacsFormula& formula, std::vector<int>& model) {
+    for (size_t i = 0; i < formula.clause_count(); ++i) {
+        if (formula.clause_size(i) == 0) return false;
+    }
+
+    ImplicationGraph graph = build_implication_graph(formula);
+    std::vector<int> component = strongly_connected_components(graph);
+
+    // A literal whose component comes later in topological order (earlier in
+    // completion order) than its negation's can be made true safely.
+    model.assign(formula.variable_count, 0);
+    for (int variable = 0; variable < formula.variable_count; ++variable) {
+        int positive = component[2 * variable];
+        int negative = component[2 * variable + 1];
+        if (positive == negative) return false;
+        model[variable] = (positive < negative) ? 1 : 0;
+    }
+    return true;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "dimacs_reader.h"
+
+#include <vector>
+
+// True when every clause has at most two literals, so the formula can be
+// decided in linear time by solve_two_sat.
+bool is_two_sat(const DimacsFormula& formula);
+
+// Decides a 2-CNF formula through the strongly connected components of its
+// implication graph. The graph is stored in CSR form and the SCCs are found
+// with an iterative Tarjan search, so deep graphs cannot overflow the stack.
+// On SAT, model[v] holds 0 or 1 for variable v + 1.
+bool solve_two_sat(const DimacsFormula& formula, std::vector<int>& model);
@@ -1,151 +1,377 @@
+#include "dimacs_reader.h"
+#include "two_sat.h"
+#include "preprocessor.h"
+#include "instrumentation.h"
+#include "budget.h"
+
 #include <iostream>
-#include <fstream>
-#include <sstream>
 #include <vector>
-#include <set>
-#include <map>
+#include <queue>
 #include <algorithm>
-#include <filesystem>
 #include <chrono>
+#include <cstdlib>
 #include <iomanip>
+#include <string>
+#include <utility>
+
+enum DPResult { DP_SAT, DP_UNSAT, DP_UNKNOWN };
+
+// Davis-Putnam by variable elimination. Clauses are sorted literal vectors
+// indexed by per-literal occurrence lists; deleted clauses stay in place and
+// are skipped. Variables are eliminated cheapest first, by the number of
+// resolvents |pos| * |neg| they can produce, so pure literals (product 0) go
+// first. Unit clauses are propagated before every elimination.
+struct DPStats {
+    long long eliminated_variables = 0;
+    long long units = 0;
+    long long resolvents = 0;
+    long long tautologies = 0;
+    long long subsumed = 0;
+    size_t peak_clauses = 0;
+    PhaseTimes times;
+};
+
+class DPSolver {
+private:
+    int num_vars = 0;
+    std::vector<std::vector<int>> clauses;
+    std::vector<char> deleted;
+    std::vector<std::vector<int>> occurrences;
+    std::vector<int> live_count;
+    std::vector<char> eliminated;
+    std::vector<int> pending_units;
+    size_t live_clauses = 0;
+    size_t clause_limit = 0;
+    bool empty_clause = false;
+
+    // Min-heap of (|pos| * |neg|, variable). Entries go stale as counts
+    // change; they are re-checked when popped.
+    using Candidate = std::pair<long long, int>;
+    std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> queue;
+
+    std::vector<int> resolvent;
+    std::vector<std::vector<int>> resolvents;
 
-using Clause = std::set<int>;
-using CNF = std::vector<Clause>;
+    DPStats statistics;
+    ProgressClock progress;
+    Budget budget;
 
-CNF parse_cnf(const std::string &filename) {
-    std::ifstream file(filename);
-    std::string line;
-    CNF formula;
+    long long elimination_cost(int v) const { return (long long)live_count[2 * v] * live_count[2 * v + 1]; }
+    void touch(int lit) { queue.push({elimination_cost(std::abs(lit) - 1), std::abs(lit) - 1}); }
 
-    if (!file.is_open()) {
-        std::cerr << "Error: Could not open file " << filename << "\n";
-        return formula;
+    void add_clause(std::vector<int> clause);
+    void delete_clause(int c);
+    const std::vector<int>& live_occurrences(int lit);
+    bool propagate_units();
+    bool resolve(const std::vector<int>& pos, const std::vector<int>& neg, int var);
+    void subsume_backward(int c);
+    DPResult eliminate(int v);
+
+public:
+    DPSolver(const DimacsFormula& dimacs, double max_growth);
+    DPResult solve();
+    size_t clause_count() const { return live_clauses; }
+
+    // Times the elimination phases for stats(), and prints a progress line
+    // every progress_interval seconds (0 never).
+    void set_instrumentation(bool time_phases, double progress_interval) {
+        statistics.times.enabled = time_phases;
+        progress.start(progress_interval);
     }
+    const DPStats& stats() const { return statistics; }
 
-    while (std::getline(file, line)) {
-        if (line.empty() || line[0] == 'c') continue;
-        if (line[0] == 'p') continue;
+    // Starts the clock for the timeout; solve() returns DP_UNKNOWN once a
+    // limit is hit, and budget_exceeded() names it.
+    void set_budget(const BudgetLimits& limits) { budget.start(limits); }
+    BudgetLimit budget_exceeded() const { return budget.exceeded(); }
+};
 
-        std::istringstream iss(line);
-        int lit;
-        Clause clause;
-        while (iss >> lit && lit != 0) clause.insert(lit);
-        
-        if (!clause.empty()) formula.push_back(clause);
+DPSolver::DPSolver(const DimacsFormula& dimacs, double max_growth) : num_vars(dimacs.variable_count) {
+    occurrences.assign(2 * (size_t)num_vars, {});
+    live_count.assign(2 * (size_t)num_vars, 0);
+    eliminated.assign(num_vars, 0);
+    clause_limit = (size_t)(max_growth * (double)std::max<size_t>(dimacs.clause_count(), 1));
+
+    for (size_t i = 0; i < dimacs.clause_count(); ++i) {
+        std::vector<int> clause(dimacs.clause_begin(i), dimacs.clause_end(i));
+        bool tautology = normalize_clause(clause);
+        if (!tautology) add_clause(std::move(clause));
     }
-    return formula;
+    for (int v = 0; v < num_vars; v++) queue.push({elimination_cost(v), v});
 }
 
-bool contains_empty_clause(const CNF &cnf) {
-    for (const auto &clause : cnf) {
-        if (clause.empty()) return true;
+void DPSolver::add_clause(std::vector<int> clause) {
+    if (clause.empty()) {
+        empty_clause = true;
+        return;
+    }
+    int c = (int)clauses.size();
+    for (int lit : clause) {
+        occurrences[lit_idx(lit)].push_back(c);
+        live_count[lit_idx(lit)]++;
     }
-    return false;
+    if (clause.size() == 1) pending_units.push_back(c);
+    clauses.push_back(std::move(clause));
+    deleted.push_back(0);
+    live_clauses++;
+    SAT_INSTRUMENT(statistics.peak_clauses = std::max(statistics.peak_clauses, live_clauses));
 }
 
-void remove_clauses_with_literal(CNF &cnf, int lit) {
-    cnf.erase(std::remove_if(cnf.begin(), cnf.end(),
-        [lit](const Clause &c) { return c.count(lit); }), cnf.end());
+void DPSolver::delete_clause(int c) {
+    deleted[c] = 1;
+    live_clauses--;
+    for (int lit : clauses[c]) {
+        live_count[lit_idx(lit)]--;
+        touch(lit);
+    }
+    std::vector<int>().swap(clauses[c]);
 }
 
-void remove_literal_from_clauses(CNF &cnf, int lit) {
-    for (auto &clause : cnf) {
-        clause.erase(lit);
-    }
+// Drops deleted clauses from the occurrence list of lit and returns it.
+const std::vector<int>& DPSolver::live_occurrences(int lit) {
+    std::vector<int>& list = occurrences[lit_idx(lit)];
+    list.erase(std::remove_if(list.begin(), list.end(), [this](int c) { return deleted[c]; }), list.end());
+    return list;
 }
 
-bool unit_propagate(CNF &cnf, std::set<int> &assignments) {
-    bool changed = true;
-    while (changed) {
-        changed = false;
-        for (auto it = cnf.begin(); it != cnf.end(); ) {
-            if (it->size() == 1) {
-                int unit = *it->begin();
-                assignments.insert(unit);
-                remove_clauses_with_literal(cnf, unit);
-                remove_literal_from_clauses(cnf, -unit);
-                changed = true;
-                it = cnf.begin();
-            } else {
-                ++it;
-            }
+// Assigns every pending unit: clauses it satisfies are deleted and its
+// negation is removed from the rest. Returns false on an empty clause.
+bool DPSolver::propagate_units() {
+    SAT_PHASE(statistics.times, phase_propagate);
+    while (!pending_units.empty() && !empty_clause) {
+        int c = pending_units.back();
+        pending_units.pop_back();
+        if (deleted[c]) continue;
+        SAT_INSTRUMENT(statistics.units++);
+
+        int unit = clauses[c][0];
+        int v = std::abs(unit) - 1;
+        eliminated[v] = 1;
+
+        for (int satisfied : live_occurrences(unit)) delete_clause(satisfied);
+        for (int shortened : live_occurrences(-unit)) {
+            std::vector<int>& clause = clauses[shortened];
+            clause.erase(std::lower_bound(clause.begin(), clause.end(), -unit));
+            live_count[lit_idx(-unit)]--;
+            if (clause.empty()) empty_clause = true;
+            else if (clause.size() == 1) pending_units.push_back(shortened);
         }
+        occurrences[lit_idx(unit)].clear();
+        occurrences[lit_idx(-unit)].clear();
     }
-    return !contains_empty_clause(cnf);
+    return !empty_clause;
 }
 
-void eliminate_pure_literals(CNF &cnf, std::set<int> &assignments) {
-    std::map<int, int> literal_count;
-    for (const auto &clause : cnf) {
-        for (int lit : clause) literal_count[lit]++;
+// Merges two sorted clauses into resolvent, leaving out var and -var.
+// Returns false if the resolvent is a tautology.
+bool DPSolver::resolve(const std::vector<int>& pos, const std::vector<int>& neg, int var) {
+    resolvent.clear();
+    size_t i = 0, j = 0;
+    while (i < pos.size() || j < neg.size()) {
+        int lit;
+        if (j == neg.size() || (i < pos.size() && pos[i] < neg[j])) lit = pos[i++];
+        else if (i == pos.size() || neg[j] < pos[i]) lit = neg[j++];
+        else {
+            lit = pos[i++];
+            j++;
+        }
+        if (lit == var || lit == -var) continue;
+        resolvent.push_back(lit);
     }
+    // Negative literals sort first, so looking up the negation of each of
+    // them finds every complementary pair.
+    for (int lit : resolvent) {
+        if (lit >= 0) break;
+        if (std::binary_search(resolvent.begin(), resolvent.end(), -lit)) return false;
+    }
+    return true;
+}
 
-    for (const auto &[lit, count] : literal_count) {
-        if (literal_count.find(-lit) == literal_count.end()) {
-            assignments.insert(lit);
-            remove_clauses_with_literal(cnf, lit);
+// Deletes every clause that contains clause c. Candidates are taken from
+// the occurrence list of c's rarest literal.
+void DPSolver::subsume_backward(int c) {
+    SAT_PHASE(statistics.times, phase_subsume);
+    const std::vector<int>& clause = clauses[c];
+    int rarest = clause[0];
+    for (int lit : clause) {
+        if (live_count[lit_idx(lit)] < live_count[lit_idx(rarest)]) rarest = lit;
+    }
+    for (int d : live_occurrences(rarest)) {
+        if (d == c || deleted[d] || clauses[d].size() < clause.size()) continue;
+        if (std::includes(clauses[d].begin(), clauses[d].end(), clause.begin(), clause.end())) {
+            delete_clause(d);
+            SAT_INSTRUMENT(statistics.subsumed++);
         }
     }
 }
 
-CNF resolve_on_variable(const CNF &cnf, int var) {
-    CNF pos_clauses, neg_clauses, rest;
-    for (const auto &clause : cnf) {
-        if (clause.count(var)) pos_clauses.push_back(clause);
-        else if (clause.count(-var)) neg_clauses.push_back(clause);
-        else rest.push_back(clause);
-    }
-
-    CNF resolvents = rest;
-    for (const auto &c1 : pos_clauses) {
-        for (const auto &c2 : neg_clauses) {
-            Clause resolvent;
-            for (int l : c1) if (l != var) resolvent.insert(l);
-            for (int l : c2) if (l != -var) resolvent.insert(l);
-            resolvents.push_back(resolvent);
+DPResult DPSolver::eliminate(int v) {
+    eliminated[v] = 1;
+    int var = v + 1;
+    std::vector<int> pos = live_occurrences(var);
+    std::vector<int> neg = live_occurrences(-var);
+
+    resolvents.clear();
+    {
+        SAT_PHASE(statistics.times, phase_resolve);
+        for (int p : pos) {
+            for (int n : neg) {
+                if (budget.exhausted(0, 0, statistics.resolvents)) return DP_UNKNOWN;
+                if (!resolve(clauses[p], clauses[n], var)) {
+                    SAT_INSTRUMENT(statistics.tautologies++);
+                    continue;
+                }
+                // Counted even without instrumentation: the resolvent budget reads it.
+                statistics.resolvents++;
+                if (resolvent.empty()) return DP_UNSAT;
+                resolvents.push_back(resolvent);
+            }
         }
     }
-    return resolvents;
+
+    for (int c : pos) delete_clause(c);
+    for (int c : neg) delete_clause(c);
+    occurrences[lit_idx(var)].clear();
+    occurrences[lit_idx(-var)].clear();
+
+    for (std::vector<int>& clause : resolvents) {
+        add_clause(std::move(clause));
+        subsume_backward((int)clauses.size() - 1);
+        if (live_clauses > clause_limit) return DP_UNKNOWN;
+    }
+    return DP_SAT;
 }
 
-bool davis_putnam(CNF cnf, std::set<int> &assignments) {
-    if (contains_empty_clause(cnf)) return false;
-    if (cnf.empty()) return true;
+DPResult DPSolver::solve() {
+    if (empty_clause) return DP_UNSAT;
+
+    while (true) {
+        if (!propagate_units()) return DP_UNSAT;
+
+        int v = -1;
+        while (!queue.empty()) {
+            Candidate top = queue.top();
+            queue.pop();
+            if (eliminated[top.second]) continue;
+            long long cost = elimination_cost(top.second);
+            if (cost != top.first) {
+                queue.push({cost, top.second});
+                continue;
+            }
+            v = top.second;
+            break;
+        }
+        // Every variable is gone and no empty clause was derived.
+        if (v == -1) return DP_SAT;
 
-    if (!unit_propagate(cnf, assignments)) return false;
-    eliminate_pure_literals(cnf, assignments);
-    if (cnf.empty()) return true;
-    if (contains_empty_clause(cnf)) return false;
+        DPResult result = eliminate(v);
+        statistics.eliminated_variables++;
+        if (result != DP_SAT) return result;
 
-    std::set<int> vars;
-    for (const auto &clause : cnf) {
-        for (int lit : clause) vars.insert(std::abs(lit));
+        if (progress.due()) {
+            std::cout << progress.label() << statistics.eliminated_variables << " of " << num_vars
+                      << " variables eliminated, " << live_clauses << " clauses" << std::endl;
+        }
     }
-    
-    if (vars.empty()) return true;
+}
 
-    int var = *vars.begin();
-    CNF reduced = resolve_on_variable(cnf, var);
-    return davis_putnam(reduced, assignments);
+void print_usage() {
+    std::cerr << "Usage: ./dp_solver [--no-2sat] [--preprocess] [--stats] [--progress <seconds>]\n"
+              << "                   [--max-growth <factor>] <input_file.cnf | ->\n"
+              << "  --max-growth <factor>  Give up (UNKNOWN) once the clause set grows beyond\n"
+              << "                         factor times its input size (default: 10)\n";
+    print_budget_usage(std::cerr, resolution_budgets);
 }
 
 int main(int argc, char* argv[]) {
-    if (argc < 2) {
-        std::cerr << "Usage: ./dp_solver <input_file.cnf>\n";
+    std::string filename;
+    bool use_two_sat = true;
+    bool preprocess = false;
+    bool print_stats = false;
+    double progress_interval = 0.0;
+    double max_growth = 10.0;
+    BudgetLimits limits;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (parse_budget_option(argc, argv, i, resolution_budgets, limits)) continue;
+        if (arg == "-h" || arg == "--help") {
+            print_usage();
+            return 0;
+        } else if (arg == "--no-2sat") use_two_sat = false;
+        else if (arg == "--preprocess") preprocess = true;
+        else if (arg == "--stats") print_stats = true;
+        else if (arg == "--progress" && i + 1 < argc) progress_interval = std::max(0.0, std::stod(argv[++i]));
+        else if (arg == "--max-growth" && i + 1 < argc) max_growth = std::max(1.0, std::stod(argv[++i]));
+        else if (arg.size() > 1 && arg[0] == '-') {
+            std::cerr << "Error: Unknown option " << arg << "\n";
+            print_usage();
+            return 1;
+        } else filename = arg;
+    }
+    if (filename.empty()) {
+        print_usage();
         return 1;
     }
-    std::string filename = argv[1];
 
-    CNF cnf = parse_cnf(filename);
-    std::set<int> assignments;
+    DimacsFormula dimacs;
+    std::string error;
+    if (!read_dimacs(filename, dimacs, error)) {
+        std::cerr << "Error: " << error << "\n";
+        return 1;
+    }
+
+    Preprocessor preprocessor;
+    if (preprocess) {
+        DimacsFormula reduced;
+        if (!preprocessor.run(dimacs, reduced)) {
+            std::cout << "UNSAT in " << preprocessor.stats().milliseconds << " ms\n";
+            report_preprocess(preprocessor.stats());
+            report_load(dimacs.load_stats);
+            return 0;
+        }
+        dimacs = std::move(reduced);
+    }
+
+    if (use_two_sat && is_two_sat(dimacs)) {
+        std::vector<int> model;
+        auto start = std::chrono::high_resolution_clock::now();
+        bool sat = solve_two_sat(dimacs, model);
+        auto end = std::chrono::high_resolution_clock::now();
+
+        double ms = std::chrono::duration<double, std::milli>(end - start).count();
+        std::cout << (sat ? "SAT" : "UNSAT") << " in " << ms << " ms\n";
+        std::cout << "c solved by the 2-SAT implication graph engine\n";
+        if (preprocess) report_preprocess(preprocessor.stats());
+        report_load(dimacs.load_stats);
+        return 0;
+    }
 
     auto start = std::chrono::high_resolution_clock::now();
-    bool sat = davis_putnam(cnf, assignments);
+    DPSolver solver(dimacs, max_growth);
+    solver.set_instrumentation(print_stats, progress_interval);
+    solver.set_budget(limits);
+    DPResult result = solver.solve();
     auto end = std::chrono::high_resolution_clock::now();
 
     double ms = std::chrono::duration<double, std::milli>(end - start).count();
-    std::string outcome = (sat ? "SAT" : "UNSAT");
-    
+    std::string outcome = (result == DP_SAT) ? "SAT" : (result == DP_UNSAT) ? "UNSAT" : "UNKNOWN";
+
     std::cout << outcome << " in " << ms << " ms\n";
+    if (result == DP_UNKNOWN && solver.budget_exceeded() == BudgetLimit::none) {
+        std::cout << "c clause growth bound exceeded at " << solver.clause_count() << " clauses\n";
+    }
+    if (preprocess) report_preprocess(preprocessor.stats());
+    report_load(dimacs.load_stats);
+    if (solver.budget_exceeded() != BudgetLimit::none) report_budget(solver.budget_exceeded());
+
+    if (print_stats) {
+        const DPStats& stats = solver.stats();
+        std::cout << "c eliminated variables: " << stats.eliminated_variables << "\n"
+                  << "c unit clauses: " << stats.units << "\n"
+                  << "c resolvents: " << stats.resolvents << " (" << stats.tautologies << " tautologies dropped)\n"
+                  << "c subsumed clauses: " << stats.subsumed << "\n"
+                  << "c peak clauses: " << stats.peak_clauses << "\n";
+        report_phase_times(stats.times, ms);
+    }
     return 0;
-}
\ No newline at end of file
+}
@@ -1,181 +1,516 @@
+#include "dimacs_reader.h"
+#include "two_sat.h"
+#include "preprocessor.h"
+#include "instrumentation.h"
+#include "batch_server.h"
+#include "budget.h"
+
 #include <iostream>
-#include <fstream>
-#include <sstream>
 #include <vector>
 #include <cmath>
 #include <chrono>
 #include <iomanip>
 #include <algorithm>
-#include <filesystem>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+enum DPLLResult { DPLL_SAT, DPLL_UNSAT, DPLL_UNKNOWN };
 
-using Literal = int;
-using Clause = std::vector<Literal>;
-using CNF = std::vector<Clause>;
 enum Val { UNASSIGNED = -1, FALSE_VAL = 0, TRUE_VAL = 1 };
 inline int var_idx(int lit) {
     return std::abs(lit) - 1;
 }
 
-CNF parse_cnf(const std::string& filename, int& num_vars) {
-    std::ifstream file(filename);
-    std::string line;
-    CNF formula;
-    num_vars = 0;
-
-    if (!file.is_open()) {
-        std::cerr << "Error: Could not open file " << filename << "\n";
-        return formula;
-    }
-
-    while (std::getline(file, line)) {
-        if (line.empty() || line[0] == 'c') continue;
-        
-        if (line[0] == 'p') {
-            std::istringstream iss(line);
-            std::string tmp;
-            int num_clauses;
-            iss >> tmp >> tmp >> num_vars >> num_clauses;
-        } else {
-            std::istringstream iss(line);
-            int lit;
-            Clause clause;
-            while (iss >> lit && lit != 0) {
-                clause.push_back(lit);
-                if (std::abs(lit) > num_vars) num_vars = std::abs(lit);
-            }
-            if (!clause.empty()) formula.push_back(clause);
+// Iterative DPLL. The search state is one trail of assigned literals and an
+// explicit stack of decisions into it; both are sized for the number of
+// variables up front, so the search itself never allocates or recurses.
+//
+// Unit propagation watches two literals per clause. Pure literals are found
+// through per-literal counts of the clauses that are not yet satisfied: a
+// clause satisfied by the trail stops counting for its other literals, and
+// once a literal's negation has no such clause left the literal is pure.
+// Branching is two-sided Jeroslow-Wang over the unsatisfied clauses.
+struct DPLLStats {
+    long long decisions = 0;
+    long long conflicts = 0;
+    long long propagations = 0;
+    long long pure_literals = 0;
+    long long clause_visits = 0;
+    PhaseTimes times;
+};
+
+class DPLLSolver {
+private:
+    struct Decision {
+        int trail_size;
+        int literal;
+        bool flipped;
+    };
+
+    int num_vars = 0;
+    bool trivially_unsat = false;
+
+    // CSR clause storage; the first two literals of each clause are watched.
+    std::vector<int> clause_literals;
+    std::vector<uint32_t> clause_starts{0};
+    std::vector<double> clause_weight;
+    std::vector<int> unit_literals;
+
+    std::vector<std::vector<int>> watches;
+    std::vector<std::vector<int>> occurrences;
+
+    std::vector<int> assignments;
+    std::vector<int> trail;
+    size_t propagation_head = 0;
+    std::vector<Decision> decisions;
+
+    // satisfied_count[c]: true literals in clause c. live_count[l] and
+    // live_weight[l]: clauses containing l with satisfied_count 0. The
+    // weights only rank branching candidates; the counts are exact.
+    std::vector<int> satisfied_count;
+    std::vector<int> live_count;
+    std::vector<double> live_weight;
+    std::vector<int> pure_candidates;
+
+    DPLLStats statistics;
+    ProgressClock progress;
+    Budget budget;
+
+    int literal_value(int lit) const {
+        int val = assignments[var_idx(lit)];
+        if (val == UNASSIGNED) return UNASSIGNED;
+        return (lit > 0) ? val : 1 - val;
+    }
+
+    void assign(int lit);
+    void unassign_to(size_t trail_size);
+    bool propagate();
+    bool eliminate_pure_literals();
+    int pick_branch_literal();
+    bool backtrack();
+
+public:
+    DPLLSolver() = default;
+    explicit DPLLSolver(const DimacsFormula& dimacs) { load(dimacs); }
+    // Replaces the formula and all search state. The buffers are reused, so
+    // one solver can work through a stream of formulas.
+    void load(const DimacsFormula& dimacs);
+    DPLLResult solve();
+    const std::vector<int>& model() const { return assignments; }
+
+    // Times the search phases for stats(), and prints a progress line every
+    // progress_interval seconds (0 never).
+    void set_instrumentation(bool time_phases, double progress_interval) {
+        statistics.times.enabled = time_phases;
+        progress.start(progress_interval);
+    }
+    const DPLLStats& stats() const { return statistics; }
+
+    // Starts the clock for the timeout; solve() returns DPLL_UNKNOWN once a
+    // limit is hit, and budget_exceeded() names it.
+    void set_budget(const BudgetLimits& limits) { budget.start(limits); }
+    BudgetLimit budget_exceeded() const { return budget.exceeded(); }
+};
+
+void DPLLSolver::load(const DimacsFormula& dimacs) {
+    num_vars = dimacs.variable_count;
+    trivially_unsat = false;
+    clause_literals.clear();
+    clause_starts.assign(1, 0);
+    clause_weight.clear();
+    unit_literals.clear();
+    trail.clear();
+    propagation_head = 0;
+    decisions.clear();
+    pure_candidates.clear();
+    bool time_phases = statistics.times.enabled;
+    statistics = DPLLStats();
+    statistics.times.enabled = time_phases;
+
+    if (watches.size() < 2 * (size_t)num_vars) {
+        watches.resize(2 * (size_t)num_vars);
+        occurrences.resize(2 * (size_t)num_vars);
+    }
+    for (size_t l = 0; l < 2 * (size_t)num_vars; l++) {
+        watches[l].clear();
+        occurrences[l].clear();
+    }
+    live_count.assign(2 * (size_t)num_vars, 0);
+    live_weight.assign(2 * (size_t)num_vars, 0.0);
+    assignments.assign(num_vars, UNASSIGNED);
+    trail.reserve(num_vars);
+    decisions.reserve(num_vars);
+    pure_candidates.reserve(num_vars);
+    clause_literals.reserve(dimacs.literals.size());
+
+    std::vector<int> clause;
+    for (size_t i = 0; i < dimacs.clause_count(); ++i) {
+        clause.assign(dimacs.clause_begin(i), dimacs.clause_end(i));
+        bool tautology = normalize_clause(clause);
+        if (tautology) continue;
+        if (clause.empty()) {
+            trivially_unsat = true;
+            continue;
+        }
+        if (clause.size() == 1) {
+            unit_literals.push_back(clause[0]);
+            continue;
         }
+
+        int id = (int)clause_weight.size();
+        double weight = std::ldexp(1.0, -(int)std::min<size_t>(clause.size(), 64));
+        clause_weight.push_back(weight);
+        for (int lit : clause) {
+            clause_literals.push_back(lit);
+            occurrences[lit_idx(lit)].push_back(id);
+            live_count[lit_idx(lit)]++;
+            live_weight[lit_idx(lit)] += weight;
+        }
+        clause_starts.push_back((uint32_t)clause_literals.size());
+        watches[lit_idx(clause[0])].push_back(id);
+        watches[lit_idx(clause[1])].push_back(id);
+    }
+    satisfied_count.assign(clause_weight.size(), 0);
+
+    for (int v = 0; v < num_vars; v++) {
+        if (live_count[2 * v] == 0 || live_count[2 * v + 1] == 0) pure_candidates.push_back(v);
     }
-    return formula;
 }
 
-Val evaluate_clause(const Clause& clause, const std::vector<int>& assignments) {
-    bool is_unresolved = false;
-    for (int lit : clause) {
-        int idx = var_idx(lit);
-        int val = assignments[idx];
-        
-        if (val != UNASSIGNED) {
-            if ((lit > 0 && val == TRUE_VAL) || (lit < 0 && val == FALSE_VAL)) {
-                return TRUE_VAL;
-            }
-        } else {
-            is_unresolved = true;
+void DPLLSolver::assign(int lit) {
+    assignments[var_idx(lit)] = (lit > 0) ? TRUE_VAL : FALSE_VAL;
+    trail.push_back(lit);
+
+    for (int c : occurrences[lit_idx(lit)]) {
+        if (satisfied_count[c]++ != 0) continue;
+        for (uint32_t k = clause_starts[c]; k < clause_starts[c + 1]; k++) {
+            int other = lit_idx(clause_literals[k]);
+            live_weight[other] -= clause_weight[c];
+            if (--live_count[other] == 0) pure_candidates.push_back(other >> 1);
         }
     }
+}
 
-    if (is_unresolved) return UNASSIGNED;
+// Undoes assignments in reverse order until the trail has trail_size entries.
+void DPLLSolver::unassign_to(size_t trail_size) {
+    while (trail.size() > trail_size) {
+        int lit = trail.back();
+        trail.pop_back();
+        assignments[var_idx(lit)] = UNASSIGNED;
 
-    return FALSE_VAL;
-}
-bool unit_propagate(const CNF& cnf, std::vector<int>& assignments, std::vector<int>& changes) {
-    bool changed = true;
-    while (changed) {
-        changed = false;
-        for (const auto& clause : cnf) {
-            Val status = evaluate_clause(clause, assignments);
-            
-            if (status == TRUE_VAL) continue;
-            if (status == FALSE_VAL) return false;
-            int unassigned_lit = 0;
-            int unassigned_count = 0;
-            
-            for (int lit : clause) {
-                if (assignments[var_idx(lit)] == UNASSIGNED) {
-                    unassigned_lit = lit;
-                    unassigned_count++;
-                }
+        for (int c : occurrences[lit_idx(lit)]) {
+            if (--satisfied_count[c] != 0) continue;
+            for (uint32_t k = clause_starts[c]; k < clause_starts[c + 1]; k++) {
+                int other = lit_idx(clause_literals[k]);
+                live_weight[other] += clause_weight[c];
+                live_count[other]++;
             }
+        }
+    }
+    propagation_head = trail.size();
+    pure_candidates.clear();
+}
 
-            if (unassigned_count == 0) return false; 
+bool DPLLSolver::propagate() {
+    SAT_PHASE(statistics.times, phase_propagate);
+    while (propagation_head < trail.size()) {
+        int false_lit = -trail[propagation_head++];
+        std::vector<int>& watch_list = watches[lit_idx(false_lit)];
+        SAT_INSTRUMENT(statistics.propagations++);
 
-            if (unassigned_count == 1) {
-                int idx = var_idx(unassigned_lit);
-                int required_val = (unassigned_lit > 0) ? TRUE_VAL : FALSE_VAL;
-                
-                if (assignments[idx] != UNASSIGNED && assignments[idx] != required_val) {
-                    return false;
-                }
-                
-                if (assignments[idx] == UNASSIGNED) {
-                    assignments[idx] = required_val;
-                    changes.push_back(idx);
-                    changed = true;
+        size_t i = 0, j = 0;
+        while (i < watch_list.size()) {
+            int c = watch_list[i++];
+            SAT_INSTRUMENT(statistics.clause_visits++);
+            int* lits = &clause_literals[clause_starts[c]];
+            int size = (int)(clause_starts[c + 1] - clause_starts[c]);
+            if (lits[0] == false_lit) std::swap(lits[0], lits[1]);
+
+            if (literal_value(lits[0]) == TRUE_VAL) {
+                watch_list[j++] = c;
+                continue;
+            }
+
+            bool moved = false;
+            for (int k = 2; k < size; k++) {
+                if (literal_value(lits[k]) != FALSE_VAL) {
+                    std::swap(lits[1], lits[k]);
+                    watches[lit_idx(lits[1])].push_back(c);
+                    moved = true;
+                    break;
                 }
             }
+            if (moved) continue;
+
+            watch_list[j++] = c;
+            int other_value = literal_value(lits[0]);
+            if (other_value == FALSE_VAL) {
+                while (i < watch_list.size()) watch_list[j++] = watch_list[i++];
+                watch_list.resize(j);
+                return false;
+            }
+            if (other_value == UNASSIGNED) assign(lits[0]);
         }
+        watch_list.resize(j);
     }
     return true;
 }
 
-bool dpll_solve(const CNF& cnf, std::vector<int>& assignments) {
-    std::vector<int> changes;
-    if (!unit_propagate(cnf, assignments, changes)) {
-        for (int idx : changes) assignments[idx] = UNASSIGNED;
-        return false;
-    }
-    bool all_satisfied = true;
-    for (const auto& clause : cnf) {
-        Val status = evaluate_clause(clause, assignments);
-        if (status == FALSE_VAL) {
-            for (int idx : changes) assignments[idx] = UNASSIGNED;
-            return false;
-        }
-        if (status == UNASSIGNED) {
-            all_satisfied = false;
+// Assigns every pure literal found since the last call. Pure literals
+// cannot falsify an unsatisfied clause, so no propagation is needed. Returns
+// true if anything was assigned.
+bool DPLLSolver::eliminate_pure_literals() {
+    bool assigned = false;
+    while (!pure_candidates.empty()) {
+        int v = pure_candidates.back();
+        pure_candidates.pop_back();
+        if (assignments[v] != UNASSIGNED) continue;
+
+        if (live_count[2 * v + 1] == 0) assign(v + 1);
+        else if (live_count[2 * v] == 0) assign(-v - 1);
+        else continue;
+        SAT_INSTRUMENT(statistics.pure_literals++);
+        assigned = true;
+    }
+    propagation_head = trail.size();
+    return assigned;
+}
+
+// Two-sided Jeroslow-Wang: the variable with the largest weight of
+// unsatisfied clauses across both literals, in the heavier polarity.
+// Returns 0 when every clause is satisfied. Whether a variable still occurs
+// in an unsatisfied clause is decided by the exact counts; the incrementally
+// updated weights can round to zero and only rank the candidates.
+int DPLLSolver::pick_branch_literal() {
+    SAT_PHASE(statistics.times, phase_decide);
+    int best = 0;
+    double best_score = -1.0;
+    for (int v = 0; v < num_vars; v++) {
+        if (assignments[v] != UNASSIGNED) continue;
+        int positive_count = live_count[2 * v];
+        int negative_count = live_count[2 * v + 1];
+        if (positive_count + negative_count == 0) continue;
+        double positive = live_weight[2 * v];
+        double negative = live_weight[2 * v + 1];
+        double score = positive + negative;
+        if (score > best_score) {
+            best_score = score;
+            bool heavier = positive != negative ? positive > negative : positive_count >= negative_count;
+            best = heavier ? v + 1 : -v - 1;
         }
     }
-    if (all_satisfied) return true;
-    int var_to_pick = -1;
-    for (size_t i = 0; i < assignments.size(); ++i) {
-        if (assignments[i] == UNASSIGNED) {
-            var_to_pick = i;
-            break;
+    return best;
+}
+
+// Chronological backtracking: undoes decisions whose second branch has
+// been tried and flips the most recent one that has not. Returns false when
+// the decision stack is exhausted.
+bool DPLLSolver::backtrack() {
+    SAT_PHASE(statistics.times, phase_backtrack);
+    while (!decisions.empty()) {
+        Decision& decision = decisions.back();
+        unassign_to(decision.trail_size);
+        if (!decision.flipped) {
+            decision.flipped = true;
+            decision.literal = -decision.literal;
+            assign(decision.literal);
+            return true;
         }
+        decisions.pop_back();
     }
-    assignments[var_to_pick] = TRUE_VAL;
-    if (dpll_solve(cnf, assignments)) return true;
-    
-    assignments[var_to_pick] = FALSE_VAL;
-    if (dpll_solve(cnf, assignments)) return true;
-    
-    assignments[var_to_pick] = UNASSIGNED;
+    return false;
+}
 
-    for (int idx : changes) assignments[idx] = UNASSIGNED;
+DPLLResult DPLLSolver::solve() {
+    if (trivially_unsat) return DPLL_UNSAT;
+    for (int lit : unit_literals) {
+        int value = literal_value(lit);
+        if (value == FALSE_VAL) return DPLL_UNSAT;
+        if (value == UNASSIGNED) assign(lit);
+    }
 
-    return false;
+    while (true) {
+        if (budget.exhausted(statistics.conflicts, statistics.decisions, 0)) return DPLL_UNKNOWN;
+        if (!propagate()) {
+            statistics.conflicts++;
+            if (!backtrack()) return DPLL_UNSAT;
+            continue;
+        }
+        if (eliminate_pure_literals()) continue;
+
+        int lit = pick_branch_literal();
+        if (lit == 0) break;
+        decisions.push_back({(int)trail.size(), lit, false});
+        statistics.decisions++;
+        assign(lit);
+
+        if (progress.due()) {
+            std::cout << progress.label() << statistics.decisions << " decisions, " << statistics.conflicts
+                      << " conflicts, depth " << decisions.size() << ", " << trail.size() << " of " << num_vars
+                      << " variables assigned" << std::endl;
+        }
+    }
+
+    // Variables left over occur only in satisfied clauses.
+    for (int& val : assignments) {
+        if (val == UNASSIGNED) val = FALSE_VAL;
+    }
+    return DPLL_SAT;
 }
 
 
+// Batch mode: one reusable solver per pool thread.
+class DPLLBatchWorker : public BatchWorker {
+private:
+    DPLLSolver solver;
+    bool use_two_sat;
+    bool preprocess;
+    BudgetLimits limits;
+    Preprocessor preprocessor;
+    DimacsFormula reduced;
+    std::vector<int> model;
+
+public:
+    DPLLBatchWorker(bool use_two_sat, bool preprocess, const BudgetLimits& limits)
+        : use_two_sat(use_two_sat), preprocess(preprocess), limits(limits) {}
+
+    const char* solve(const DimacsFormula& formula) override {
+        const DimacsFormula* input = &formula;
+        if (preprocess) {
+            if (!preprocessor.run(formula, reduced)) return "UNSAT";
+            input = &reduced;
+        }
+        if (use_two_sat && is_two_sat(*input)) return solve_two_sat(*input, model) ? "SAT" : "UNSAT";
+
+        solver.load(*input);
+        solver.set_budget(limits);
+        DPLLResult result = solver.solve();
+        return (result == DPLL_SAT) ? "SAT" : (result == DPLL_UNSAT) ? "UNSAT" : "UNKNOWN";
+    }
+};
+
+void print_usage() {
+    std::cerr << "Usage: ./dpll_solver [--no-2sat] [--preprocess] [--stats] [--progress <seconds>] <input_file.cnf | ->\n"
+              << "       ./dpll_solver [--no-2sat] [--preprocess] --batch | --socket <path>\n"
+              << "                     [--workers <n>] [--completion-order]\n"
+              << "Batch mode reads one request per line: a path, or \"@cnf <bytes>\" and the DIMACS text.\n";
+    print_budget_usage(std::cerr, search_budgets);
+}
+
 int main(int argc, char* argv[]) {
-    if (argc < 2) {
-        std::cerr << "Usage: ./dpll_solver <input_file.cnf>\n";
+    std::string input_path;
+    bool use_two_sat = true;
+    bool preprocess = false;
+    bool print_stats = false;
+    double progress_interval = 0.0;
+    bool batch_mode = false;
+    BatchOptions batch;
+    BudgetLimits limits;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (parse_budget_option(argc, argv, i, search_budgets, limits)) continue;
+        if (arg == "-h" || arg == "--help") {
+            print_usage();
+            return 0;
+        } else if (arg == "--no-2sat") use_two_sat = false;
+        else if (arg == "--preprocess") preprocess = true;
+        else if (arg == "--stats") print_stats = true;
+        else if (arg == "--progress" && i + 1 < argc) progress_interval = std::max(0.0, std::stod(argv[++i]));
+        else if (arg == "--batch") batch_mode = true;
+        else if (arg == "--socket" && i + 1 < argc) batch.socket_path = argv[++i];
+        else if (arg == "--workers" && i + 1 < argc) batch.workers = std::max(1, std::stoi(argv[++i]));
+        else if (arg == "--completion-order") batch.completion_order = true;
+        else if (arg.size() > 1 && arg[0] == '-') {
+            std::cerr << "Error: Unknown option " << arg << "\n";
+            print_usage();
+            return 1;
+        } else input_path = arg;
+    }
+    if (!batch.socket_path.empty()) batch_mode = true;
+    if (input_path.empty() == !batch_mode) {
+        print_usage();
+        return 1;
+    }
+
+    if (batch_mode) {
+        std::string error;
+        bool served = run_batch(batch, [&]() -> std::unique_ptr<BatchWorker> {
+            return std::make_unique<DPLLBatchWorker>(use_two_sat, preprocess, limits);
+        }, error);
+        if (!served) std::cerr << "Error: " << error << "\n";
+        return served ? 0 : 1;
+    }
+
+    DimacsFormula dimacs;
+    std::string error;
+    if (!read_dimacs(input_path, dimacs, error)) {
+        std::cerr << "Error: " << error << "\n";
         return 1;
     }
-    std::string input_path = argv[1];
 
-    int num_vars;
-    CNF cnf = parse_cnf(input_path, num_vars);
-    
-    if (cnf.empty() && num_vars == 0) {
+    if (dimacs.clause_count() == 0 && dimacs.variable_count == 0) {
         std::cerr << "Error: Empty or invalid CNF file.\n";
         return 1;
     }
 
-    std::vector<int> assignments(num_vars, UNASSIGNED);
+    Preprocessor preprocessor;
+    if (preprocess) {
+        DimacsFormula reduced;
+        if (!preprocessor.run(dimacs, reduced)) {
+            std::cout << "UNSAT in " << preprocessor.stats().milliseconds << " ms\n";
+            report_preprocess(preprocessor.stats());
+            report_load(dimacs.load_stats);
+            return 0;
+        }
+        dimacs = std::move(reduced);
+    }
+
+    if (use_two_sat && is_two_sat(dimacs)) {
+        std::vector<int> model;
+        auto start = std::chrono::high_resolution_clock::now();
+        bool sat = solve_two_sat(dimacs, model);
+        auto end = std::chrono::high_resolution_clock::now();
+
+        double ms = std::chrono::duration<double, std::milli>(end - start).count();
+        std::cout << (sat ? "SAT" : "UNSAT") << " in " << ms << " ms\n";
+        std::cout << "c solved by the 2-SAT implication graph engine\n";
+        if (preprocess) report_preprocess(preprocessor.stats());
+        report_load(dimacs.load_stats);
+        return 0;
+    }
 
     auto start = std::chrono::high_resolution_clock::now();
-    bool sat = dpll_solve(cnf, assignments);
+    DPLLSolver solver(dimacs);
+    solver.set_instrumentation(print_stats, progress_interval);
+    solver.set_budget(limits);
+    DPLLResult result = solver.solve();
     auto end = std::chrono::high_resolution_clock::now();
 
     double ms = std::chrono::duration<double, std::milli>(end - start).count();
-    
-    std::string outcome = (sat ? "SAT" : "UNSAT");
+
+    std::string outcome = (result == DPLL_SAT) ? "SAT" : (result == DPLL_UNSAT) ? "UNSAT" : "UNKNOWN";
     std::cout << outcome << " in " << ms << " ms\n";
+    if (preprocess) report_preprocess(preprocessor.stats());
+    report_load(dimacs.load_stats);
+    if (result == DPLL_UNKNOWN) report_budget(solver.budget_exceeded());
+
+    if (print_stats) {
+        const DPLLStats& stats = solver.stats();
+        std::cout << "c decisions: " << stats.decisions << "\n"
+                  << "c conflicts: " << stats.conflicts << "\n"
+                  << "c propagations: " << stats.propagations << "\n"
+                  << "c pure literals: " << stats.pure_literals << "\n"
+                  << "c clause visits: " << stats.clause_visits << " ("
+                  << (stats.propagations ? (double)stats.clause_visits / stats.propagations : 0.0)
+                  << " per propagation)\n";
+        report_phase_times(stats.times, ms);
+    }
 
     // Optional: Write to file if needed (legacy support)
     // std::ofstream out("results_DPLL.txt", std::ios::app);
     // out << input_path << ": " << outcome << " in " << ms << " ms\n";
 
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,156 @@
+#include "dimacs_reader.h"
+#include "preprocessor.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+void print_usage() {
+    std::cerr << "Usage: ./preprocess [options] <input_file.cnf | ->\n"
+              << "       ./preprocess --extend <map> <model | ->\n"
+              << "Writes the simplified formula as DIMACS, to standard output by default.\n"
+              << "Options:\n"
+              << "  -o <file>              Write the reduced formula to file\n"
+              << "  --map <file>           Write the variable map: how the reduced variables and\n"
+              << "                         the fixed values relate to the original variables\n"
+              << "  --extend <map> <model> Turn a model of the reduced formula (v lines, as SAT\n"
+              << "                         solvers print them) into v lines for the original one\n"
+              << "  --no-subsumption       Skip subsumption and strengthening\n"
+              << "  --no-strengthening     Skip self-subsuming strengthening\n"
+              << "  --no-probing           Skip failed literal probing\n";
+}
+
+// Reads the literals of "v" lines; s and c lines are skipped, so a solver's
+// whole output can be passed in.
+bool read_model(std::istream& in, std::vector<int>& model, std::string& error) {
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream words(line);
+        std::string first;
+        if (!(words >> first) || first != "v") continue;
+        long long literal;
+        while (words >> literal) {
+            if (literal == 0) continue;
+            size_t variable = (size_t)std::llabs(literal);
+            if (variable > model.size()) model.resize(variable, 0);
+            model[variable - 1] = literal > 0 ? 1 : 0;
+        }
+        if (!words.eof()) {
+            error = "Malformed model line: " + line;
+            return false;
+        }
+    }
+    return true;
+}
+
+int extend_model(const std::string& map_path, const std::string& model_path) {
+    std::ifstream map_file(map_path);
+    if (!map_file.is_open()) {
+        std::cerr << "Error: Could not open file " << map_path << "\n";
+        return 1;
+    }
+    Preprocessor preprocessor;
+    std::string error;
+    if (!preprocessor.read_map(map_file, error)) {
+        std::cerr << "Error: " << error << "\n";
+        return 1;
+    }
+
+    std::vector<int> reduced;
+    bool parsed;
+    if (model_path == "-") {
+        parsed = read_model(std::cin, reduced, error);
+    } else {
+        std::ifstream model_file(model_path);
+        if (!model_file.is_open()) {
+            std::cerr << "Error: Could not open file " << model_path << "\n";
+            return 1;
+        }
+        parsed = read_model(model_file, reduced, error);
+    }
+    if (!parsed) {
+        std::cerr << "Error: " << error << "\n";
+        return 1;
+    }
+
+    std::vector<int> model = preprocessor.map_model(reduced);
+    std::string line = "v";
+    for (size_t v = 0; v < model.size(); v++) {
+        line += ' ';
+        line += std::to_string(model[v] ? (long long)v + 1 : -(long long)v - 1);
+        if (line.size() > 72) {
+            std::cout << line << "\n";
+            line = "v";
+        }
+    }
+    std::cout << line << " 0\n";
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    PreprocessOptions options;
+    std::string input_path;
+    std::string output_path;
+    std::string map_path;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--extend" && i + 2 < argc) return extend_model(argv[i + 1], argv[i + 2]);
+        if (arg == "-h" || arg == "--help") {
+            print_usage();
+            return 0;
+        } else if (arg == "-o" && i + 1 < argc) output_path = argv[++i];
+        else if (arg == "--map" && i + 1 < argc) map_path = argv[++i];
+        else if (arg == "--no-subsumption") options.subsumption = false;
+        else if (arg == "--no-strengthening") options.strengthening = false;
+        else if (arg == "--no-probing") options.probing = false;
+        else if (arg.size() > 1 && arg[0] == '-') {
+            std::cerr << "Error: Unknown option " << arg << "\n";
+            print_usage();
+            return 1;
+        } else input_path = arg;
+    }
+    if (input_path.empty()) {
+        print_usage();
+        return 1;
+    }
+
+    DimacsFormula input;
+    std::string error;
+    if (!read_dimacs(input_path, input, error)) {
+        std::cerr << "Error: " << error << "\n";
+        return 1;
+    }
+
+    Preprocessor preprocessor(options);
+    DimacsFormula reduced;
+    if (!preprocessor.run(input, reduced)) {
+        // A single empty clause keeps the output valid and unsatisfiable.
+        reduced.clause_starts.push_back(0);
+    }
+
+    report_preprocess(preprocessor.stats());
+    report_load(input.load_stats);
+    if (!map_path.empty()) {
+        std::ofstream map_file(map_path);
+        if (!map_file.is_open()) {
+            std::cerr << "Error: Could not open file " << map_path << "\n";
+            return 1;
+        }
+        preprocessor.write_map(map_file);
+    }
+    if (output_path.empty()) {
+        write_dimacs(std::cout, reduced);
+        return 0;
+    }
+
+    std::ofstream out(output_path);
+    if (!out.is_open()) {
+        std::cerr << "Error: Could not open file " << output_path << "\n";
+        return 1;
+    }
+    write_dimacs(out, reduced);
+    return 0;
+}
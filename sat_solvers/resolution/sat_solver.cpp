@@ -1,96 +1,381 @@
+#include "dimacs_reader.h"
+#include "two_sat.h"
+#include "preprocessor.h"
+#include "instrumentation.h"
+#include "budget.h"
+
 #include <iostream>
-#include <fstream>
-#include <sstream>
 #include <vector>
-#include <set>
+#include <queue>
+#include <unordered_map>
 #include <algorithm>
 #include <chrono>
+#include <cstdint>
+#include <cstdlib>
 #include <iomanip>
+#include <string>
+#include <utility>
+
+enum ResolutionResult { RES_SAT, RES_UNSAT, RES_UNKNOWN };
+
+// Given-clause saturation. Clauses start out unprocessed; the shortest one
+// is repeatedly picked as the given clause, moved to the processed set and
+// resolved against the processed clauses that contain a complementary
+// literal, found through a per-literal index. Every pair is therefore
+// resolved at most once. New clauses are dropped if they are tautologies,
+// duplicates (looked up in a hashed store) or subsumed by a live clause, and
+// they delete the live clauses they subsume. The formula is SAT when the
+// unprocessed set runs empty without producing the empty clause.
+struct ResolutionStats {
+    long long given_clauses = 0;
+    long long resolvents = 0;
+    long long tautologies = 0;
+    long long duplicates = 0;
+    long long forward_subsumed = 0;
+    long long backward_subsumed = 0;
+    size_t peak_clauses = 0;
+    PhaseTimes times;
+};
+
+class ResolutionSolver {
+private:
+    struct StoredClause {
+        std::vector<int> literals;
+        uint64_t signature;
+        bool deleted;
+    };
+
+    std::vector<StoredClause> clauses;
+    // All live clauses by literal, for subsumption; processed ones only, for
+    // picking resolution partners.
+    std::vector<std::vector<int>> occurrences;
+    std::vector<std::vector<int>> processed_occurrences;
+    std::unordered_map<uint64_t, std::vector<int>> store;
+    size_t live_clauses = 0;
+    size_t clause_limit = 0;
+    bool empty_clause = false;
+
+    using Candidate = std::pair<size_t, int>;
+    std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> unprocessed;
+
+    std::vector<int> resolvent;
+
+    ResolutionStats statistics;
+    ProgressClock progress;
+    Budget budget;
 
-using Clause = std::set<int>;
-using CNF = std::vector<Clause>;
+    static uint64_t signature_of(const std::vector<int>& clause);
+    static uint64_t hash_of(const std::vector<int>& clause);
 
-CNF parse_cnf(const std::string &filename) {
-    std::ifstream file(filename);
-    std::string line;
-    CNF formula;
+    bool is_duplicate(const std::vector<int>& clause, uint64_t hash) const;
+    bool forward_subsumed(const std::vector<int>& clause, uint64_t signature);
+    void subsume_backward(int c);
+    void add_clause(const std::vector<int>& clause);
+    void delete_clause(int c);
+    bool resolve(const std::vector<int>& a, const std::vector<int>& b, int lit);
 
-    if (!file.is_open()) {
-        std::cerr << "Error: Could not open file " << filename << "\n";
-        return formula;
+public:
+    ResolutionSolver(const DimacsFormula& dimacs, double max_growth);
+    ResolutionResult solve();
+    size_t clause_count() const { return live_clauses; }
+
+    // Times resolution and subsumption for stats(), and prints a progress
+    // line every progress_interval seconds (0 never).
+    void set_instrumentation(bool time_phases, double progress_interval) {
+        statistics.times.enabled = time_phases;
+        progress.start(progress_interval);
     }
+    const ResolutionStats& stats() const { return statistics; }
+
+    // Starts the clock for the timeout; solve() returns RES_UNKNOWN once a
+    // limit is hit, and budget_exceeded() names it.
+    void set_budget(const BudgetLimits& limits) { budget.start(limits); }
+    BudgetLimit budget_exceeded() const { return budget.exceeded(); }
+};
 
-    while (std::getline(file, line)) {
-        if (line.empty() || line[0] == 'c') continue;
-        if (line[0] == 'p') continue;
+uint64_t ResolutionSolver::signature_of(const std::vector<int>& clause) {
+    uint64_t signature = 0;
+    for (int lit : clause) signature |= 1ull << (lit_idx(lit) & 63);
+    return signature;
+}
 
-        std::istringstream iss(line);
-        int lit;
-        Clause clause;
-        while (iss >> lit && lit != 0) clause.insert(lit);
-        formula.push_back(clause);
+uint64_t ResolutionSolver::hash_of(const std::vector<int>& clause) {
+    uint64_t hash = 1469598103934665603ull;
+    for (int lit : clause) {
+        hash ^= (uint32_t)lit;
+        hash *= 1099511628211ull;
     }
-    return formula;
+    return hash;
 }
 
-bool resolve_clauses(const Clause &c1, const Clause &c2, Clause &resolvent) {
-    for (int lit : c1) {
-        if (c2.count(-lit)) {
-            resolvent.clear();
-            for (int l : c1) if (l != lit) resolvent.insert(l);
-            for (int l : c2) if (l != -lit) resolvent.insert(l);
-            return true;
+ResolutionSolver::ResolutionSolver(const DimacsFormula& dimacs, double max_growth) {
+    occurrences.assign(2 * (size_t)dimacs.variable_count, {});
+    processed_occurrences.assign(2 * (size_t)dimacs.variable_count, {});
+    clause_limit = (size_t)(max_growth * (double)std::max<size_t>(dimacs.clause_count(), 1));
+
+    std::vector<int> clause;
+    for (size_t i = 0; i < dimacs.clause_count(); ++i) {
+        clause.assign(dimacs.clause_begin(i), dimacs.clause_end(i));
+        bool tautology = normalize_clause(clause);
+        if (tautology) continue;
+        if (clause.empty()) {
+            empty_clause = true;
+            continue;
         }
+        add_clause(clause);
+    }
+}
+
+bool ResolutionSolver::is_duplicate(const std::vector<int>& clause, uint64_t hash) const {
+    auto bucket = store.find(hash);
+    if (bucket == store.end()) return false;
+    for (int c : bucket->second) {
+        if (clauses[c].literals == clause) return true;
     }
     return false;
 }
 
-bool resolution_algorithm(CNF formula) {
-    std::set<Clause> clauses(formula.begin(), formula.end());
-    bool added = true;
-    
-    while (added) {
-        added = false;
-        std::vector<Clause> new_clauses;
-        
-        for (auto it1 = clauses.begin(); it1 != clauses.end(); ++it1) {
-            for (auto it2 = std::next(it1); it2 != clauses.end(); ++it2) {
-                Clause resolvent;
-                if (resolve_clauses(*it1, *it2, resolvent)) {
-                    if (resolvent.empty()) return false;
-                    
-                    if (clauses.find(resolvent) == clauses.end()) {
-                        new_clauses.push_back(resolvent);
-                    }
+// True if a live clause is a subset of clause. Any such clause shares at
+// least one literal with it, so the occurrence lists of clause's literals
+// hold every candidate.
+bool ResolutionSolver::forward_subsumed(const std::vector<int>& clause, uint64_t signature) {
+    SAT_PHASE(statistics.times, phase_subsume);
+    for (int lit : clause) {
+        for (int c : occurrences[lit_idx(lit)]) {
+            const StoredClause& other = clauses[c];
+            if (other.deleted || other.literals.size() > clause.size()) continue;
+            if (other.signature & ~signature) continue;
+            if (std::includes(clause.begin(), clause.end(), other.literals.begin(), other.literals.end())) return true;
+        }
+    }
+    return false;
+}
+
+// Deletes every live clause that is a superset of clause c.
+void ResolutionSolver::subsume_backward(int c) {
+    SAT_PHASE(statistics.times, phase_subsume);
+    const std::vector<int>& clause = clauses[c].literals;
+    uint64_t signature = clauses[c].signature;
+    int rarest = clause[0];
+    for (int lit : clause) {
+        if (occurrences[lit_idx(lit)].size() < occurrences[lit_idx(rarest)].size()) rarest = lit;
+    }
+    for (int d : occurrences[lit_idx(rarest)]) {
+        const StoredClause& other = clauses[d];
+        if (d == c || other.deleted || other.literals.size() < clause.size()) continue;
+        if (signature & ~other.signature) continue;
+        if (std::includes(other.literals.begin(), other.literals.end(), clause.begin(), clause.end())) {
+            delete_clause(d);
+            SAT_INSTRUMENT(statistics.backward_subsumed++);
+        }
+    }
+}
+
+void ResolutionSolver::add_clause(const std::vector<int>& clause) {
+    uint64_t hash = hash_of(clause);
+    uint64_t signature = signature_of(clause);
+    if (is_duplicate(clause, hash)) {
+        SAT_INSTRUMENT(statistics.duplicates++);
+        return;
+    }
+    if (forward_subsumed(clause, signature)) {
+        SAT_INSTRUMENT(statistics.forward_subsumed++);
+        return;
+    }
+
+    int c = (int)clauses.size();
+    clauses.push_back({clause, signature, false});
+    store[hash].push_back(c);
+    for (int lit : clause) occurrences[lit_idx(lit)].push_back(c);
+    live_clauses++;
+    SAT_INSTRUMENT(statistics.peak_clauses = std::max(statistics.peak_clauses, live_clauses));
+    subsume_backward(c);
+    unprocessed.push({clause.size(), c});
+}
+
+// Marks the clause deleted and unhooks it from the store. The occurrence
+// lists drop it lazily the next time they are compacted.
+void ResolutionSolver::delete_clause(int c) {
+    StoredClause& clause = clauses[c];
+    clause.deleted = true;
+    live_clauses--;
+    std::vector<int>& bucket = store[hash_of(clause.literals)];
+    bucket.erase(std::find(bucket.begin(), bucket.end(), c));
+}
+
+// Resolves a (containing lit) with b (containing -lit) into resolvent.
+// Returns false if the result is a tautology.
+bool ResolutionSolver::resolve(const std::vector<int>& a, const std::vector<int>& b, int lit) {
+    SAT_PHASE(statistics.times, phase_resolve);
+    resolvent.clear();
+    size_t i = 0, j = 0;
+    while (i < a.size() || j < b.size()) {
+        int next;
+        if (j == b.size() || (i < a.size() && a[i] < b[j])) next = a[i++];
+        else if (i == a.size() || b[j] < a[i]) next = b[j++];
+        else {
+            next = a[i++];
+            j++;
+        }
+        if (next == lit || next == -lit) continue;
+        resolvent.push_back(next);
+    }
+    // Negative literals sort first, so looking up the negation of each of
+    // them finds every complementary pair.
+    for (int l : resolvent) {
+        if (l >= 0) break;
+        if (std::binary_search(resolvent.begin(), resolvent.end(), -l)) return false;
+    }
+    return true;
+}
+
+ResolutionResult ResolutionSolver::solve() {
+    if (empty_clause) return RES_UNSAT;
+
+    auto is_deleted = [this](int c) { return clauses[c].deleted; };
+    std::vector<int> given_literals;
+
+    while (!unprocessed.empty()) {
+        int given = unprocessed.top().second;
+        unprocessed.pop();
+        if (clauses[given].deleted) continue;
+
+        given_literals = clauses[given].literals;
+        statistics.given_clauses++;
+        if (progress.due()) {
+            std::cout << progress.label() << statistics.given_clauses << " given clauses, " << live_clauses
+                      << " live, " << unprocessed.size() << " queued" << std::endl;
+        }
+        for (int lit : given_literals) {
+            std::vector<int>& list = processed_occurrences[lit_idx(-lit)];
+            list.erase(std::remove_if(list.begin(), list.end(), is_deleted), list.end());
+
+            // add_clause never touches the processed index, so list stays valid.
+            for (int partner : list) {
+                if (clauses[given].deleted) break;
+                if (clauses[partner].deleted) continue;
+                if (budget.exhausted(0, 0, statistics.resolvents)) return RES_UNKNOWN;
+                if (!resolve(given_literals, clauses[partner].literals, lit)) {
+                    SAT_INSTRUMENT(statistics.tautologies++);
+                    continue;
                 }
+                // Counted even without instrumentation: the resolvent budget reads it.
+                statistics.resolvents++;
+                if (resolvent.empty()) return RES_UNSAT;
+                add_clause(resolvent);
+                if (live_clauses > clause_limit) return RES_UNKNOWN;
             }
         }
-        
-        for (const auto &c : new_clauses) {
-            if (clauses.insert(c).second) {
-                added = true;
-            }
+
+        // A resolvent may have subsumed the given clause itself.
+        if (clauses[given].deleted) continue;
+        for (int lit : given_literals) {
+            std::vector<int>& list = occurrences[lit_idx(lit)];
+            list.erase(std::remove_if(list.begin(), list.end(), is_deleted), list.end());
+            processed_occurrences[lit_idx(lit)].push_back(given);
         }
     }
-    return true;
+    return RES_SAT;
+}
+
+void print_usage() {
+    std::cerr << "Usage: ./resolution_solver [--no-2sat] [--preprocess] [--stats] [--progress <seconds>]\n"
+              << "                           [--max-growth <factor>] <input_file.cnf | ->\n"
+              << "  --max-growth <factor>  Give up (UNKNOWN) once the clause set grows beyond\n"
+              << "                         factor times its input size (default: 100)\n";
+    print_budget_usage(std::cerr, resolution_budgets);
 }
 
 int main(int argc, char* argv[]) {
-    if (argc < 2) {
-        std::cerr << "Usage: ./resolution_solver <input_file.cnf>\n";
+    std::string filename;
+    bool use_two_sat = true;
+    bool preprocess = false;
+    bool print_stats = false;
+    double progress_interval = 0.0;
+    double max_growth = 100.0;
+    BudgetLimits limits;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (parse_budget_option(argc, argv, i, resolution_budgets, limits)) continue;
+        if (arg == "-h" || arg == "--help") {
+            print_usage();
+            return 0;
+        } else if (arg == "--no-2sat") use_two_sat = false;
+        else if (arg == "--preprocess") preprocess = true;
+        else if (arg == "--stats") print_stats = true;
+        else if (arg == "--progress" && i + 1 < argc) progress_interval = std::max(0.0, std::stod(argv[++i]));
+        else if (arg == "--max-growth" && i + 1 < argc) max_growth = std::max(1.0, std::stod(argv[++i]));
+        else if (arg.size() > 1 && arg[0] == '-') {
+            std::cerr << "Error: Unknown option " << arg << "\n";
+            print_usage();
+            return 1;
+        } else filename = arg;
+    }
+    if (filename.empty()) {
+        print_usage();
+        return 1;
+    }
+
+    DimacsFormula dimacs;
+    std::string error;
+    if (!read_dimacs(filename, dimacs, error)) {
+        std::cerr << "Error: " << error << "\n";
         return 1;
     }
-    std::string filename = argv[1];
 
-    CNF cnf = parse_cnf(filename);
+    Preprocessor preprocessor;
+    if (preprocess) {
+        DimacsFormula reduced;
+        if (!preprocessor.run(dimacs, reduced)) {
+            std::cout << "UNSAT in " << preprocessor.stats().milliseconds << " ms\n";
+            report_preprocess(preprocessor.stats());
+            report_load(dimacs.load_stats);
+            return 0;
+        }
+        dimacs = std::move(reduced);
+    }
+
+    if (use_two_sat && is_two_sat(dimacs)) {
+        std::vector<int> model;
+        auto start = std::chrono::high_resolution_clock::now();
+        bool sat = solve_two_sat(dimacs, model);
+        auto end = std::chrono::high_resolution_clock::now();
+
+        double ms = std::chrono::duration<double, std::milli>(end - start).count();
+        std::cout << (sat ? "SAT" : "UNSAT") << " in " << ms << " ms\n";
+        std::cout << "c solved by the 2-SAT implication graph engine\n";
+        if (preprocess) report_preprocess(preprocessor.stats());
+        report_load(dimacs.load_stats);
+        return 0;
+    }
 
     auto start = std::chrono::high_resolution_clock::now();
-    bool sat = resolution_algorithm(cnf);
+    ResolutionSolver solver(dimacs, max_growth);
+    solver.set_instrumentation(print_stats, progress_interval);
+    solver.set_budget(limits);
+    ResolutionResult result = solver.solve();
     auto end = std::chrono::high_resolution_clock::now();
 
     double ms = std::chrono::duration<double, std::milli>(end - start).count();
-    std::string outcome = (sat ? "SAT" : "UNSAT");
-    
+    std::string outcome = (result == RES_SAT) ? "SAT" : (result == RES_UNSAT) ? "UNSAT" : "UNKNOWN";
+
     std::cout << outcome << " in " << ms << " ms\n";
+    if (result == RES_UNKNOWN && solver.budget_exceeded() == BudgetLimit::none) {
+        std::cout << "c clause growth bound exceeded at " << solver.clause_count() << " clauses\n";
+    }
+    if (preprocess) report_preprocess(preprocessor.stats());
+    report_load(dimacs.load_stats);
+    if (solver.budget_exceeded() != BudgetLimit::none) report_budget(solver.budget_exceeded());
+
+    if (print_stats) {
+        const ResolutionStats& stats = solver.stats();
+        std::cout << "c given clauses: " << stats.given_clauses << "\n"
+                  << "c resolvents: " << stats.resolvents << " (" << stats.tautologies << " tautologies dropped)\n"
+                  << "c duplicates: " << stats.duplicates << "\n"
+                  << "c subsumed: " << stats.forward_subsumed << " forward, " << stats.backward_subsumed
+                  << " backward\n"
+                  << "c peak clauses: " << stats.peak_clauses << "\n";
+        report_phase_times(stats.times, ms);
+    }
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,146 @@
+#include "sls_solver.h"
+#include "dimacs_reader.h"
+#include "two_sat.h"
+#include "preprocessor.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+void print_usage() {
+    std::cerr << "Usage: ./sls_solver [options] <input_file.cnf | ->\n"
+              << "Local search only proves satisfiability: it prints SAT or, once the flip\n"
+              << "budget is spent, UNKNOWN.\n"
+              << "Options:\n"
+              << "  --algorithm <probsat|walksat>  Flip selection (default: probsat)\n"
+              << "  --max-flips <n>                Total flip budget (default: 100000000)\n"
+              << "  --restart-flips <n>            Flips before a fresh random assignment,\n"
+              << "                                 0 never restarts (default: 0)\n"
+              << "  --cb <value>                   probSAT break base, 0 picks it from the clause\n"
+              << "                                 width (default: 0)\n"
+              << "  --eps <value>                  probSAT polynomial break offset (default: 0.9)\n"
+              << "  --noise <p>                    WalkSAT random walk probability (default: 0.567)\n"
+              << "  --seed <n>                     Random seed (default: 1)\n"
+              << "  --no-2sat                      Do not hand all-binary formulas to the 2-SAT engine\n"
+              << "  --preprocess                   Simplify the formula first\n"
+              << "  --stats                        Print the flip rate after the result\n"
+              << "  --progress <seconds>           Print a progress line at this interval (default: 0, off)\n";
+    print_budget_usage(std::cerr, local_search_budgets);
+}
+
+bool parse_arguments(int argc, char* argv[], SLSOptions& options, std::string& filename, bool& use_two_sat,
+                     bool& preprocess, bool& print_stats, bool& help) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+
+        if (arg == "-h" || arg == "--help") {
+            help = true;
+            return true;
+        } else if (arg == "--algorithm" && has_value) {
+            std::string value = argv[++i];
+            if (value == "probsat") options.algorithm = SLSAlgorithm::probsat;
+            else if (value == "walksat") options.algorithm = SLSAlgorithm::walksat;
+            else {
+                std::cerr << "Error: Unknown algorithm " << value << "\n";
+                return false;
+            }
+        } else if (arg == "--max-flips" && has_value) {
+            options.max_flips = std::max(0LL, std::stoll(argv[++i]));
+        } else if (arg == "--restart-flips" && has_value) {
+            options.restart_flips = std::max(0LL, std::stoll(argv[++i]));
+        } else if (arg == "--cb" && has_value) {
+            options.cb = std::stod(argv[++i]);
+        } else if (arg == "--eps" && has_value) {
+            options.eps = std::stod(argv[++i]);
+        } else if (arg == "--noise" && has_value) {
+            options.noise = std::stod(argv[++i]);
+        } else if (arg == "--seed" && has_value) {
+            options.seed = std::stoull(argv[++i]);
+        } else if (arg == "--no-2sat") {
+            use_two_sat = false;
+        } else if (arg == "--preprocess") {
+            preprocess = true;
+        } else if (arg == "--stats") {
+            print_stats = true;
+        } else if (arg == "--progress" && has_value) {
+            options.progress_interval = std::max(0.0, std::stod(argv[++i]));
+        } else if (parse_budget_option(argc, argv, i, local_search_budgets, options.limits)) {
+            continue;
+        } else if (arg.size() > 1 && arg[0] == '-' && arg != "-") {
+            std::cerr << "Error: Unknown option " << arg << "\n";
+            return false;
+        } else {
+            filename = arg;
+        }
+    }
+    return !filename.empty();
+}
+
+int main(int argc, char* argv[]) {
+    SLSOptions options;
+    std::string filename;
+    bool use_two_sat = true;
+    bool preprocess = false;
+    bool print_stats = false;
+    bool help = false;
+    bool parsed = parse_arguments(argc, argv, options, filename, use_two_sat, preprocess, print_stats, help);
+    if (help || !parsed) {
+        print_usage();
+        return help ? 0 : 1;
+    }
+
+    DimacsFormula dimacs;
+    std::string error;
+    if (!read_dimacs(filename, dimacs, error)) {
+        std::cerr << "Error: " << error << "\n";
+        return 1;
+    }
+
+    Preprocessor preprocessor;
+    if (preprocess) {
+        DimacsFormula reduced;
+        if (!preprocessor.run(dimacs, reduced)) {
+            std::cout << "UNSAT in " << preprocessor.stats().milliseconds << " ms\n";
+            report_preprocess(preprocessor.stats());
+            report_load(dimacs.load_stats);
+            return 0;
+        }
+        dimacs = std::move(reduced);
+    }
+
+    if (use_two_sat && is_two_sat(dimacs)) {
+        std::vector<int> model;
+        auto start = std::chrono::high_resolution_clock::now();
+        bool sat = solve_two_sat(dimacs, model);
+        auto end = std::chrono::high_resolution_clock::now();
+
+        double ms = std::chrono::duration<double, std::milli>(end - start).count();
+        std::cout << (sat ? "SAT" : "UNSAT") << " in " << ms << " ms\n";
+        std::cout << "c solved by the 2-SAT implication graph engine\n";
+        if (preprocess) report_preprocess(preprocessor.stats());
+        report_load(dimacs.load_stats);
+        return 0;
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    SLSSolver solver(dimacs, options);
+    bool sat = solver.solve();
+    auto end = std::chrono::high_resolution_clock::now();
+
+    double ms = std::chrono::duration<double, std::milli>(end - start).count();
+    const SLSStats& stats = solver.stats();
+    std::cout << (sat ? "SAT" : "UNKNOWN") << " in " << ms << " ms\n";
+    std::cout << "c local search: " << stats.flips << " flips, " << stats.restarts << " restarts, best "
+              << stats.best_unsatisfied << " unsatisfied clauses\n";
+    if (preprocess) report_preprocess(preprocessor.stats());
+    report_load(dimacs.load_stats);
+    if (solver.budget_exceeded() != BudgetLimit::none) report_budget(solver.budget_exceeded());
+    if (print_stats) {
+        std::cout << "c flips per second: " << (ms > 0.0 ? stats.flips / (ms / 1000.0) : 0.0) << "\n";
+    }
+    return 0;
+}
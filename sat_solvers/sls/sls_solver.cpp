@@ -0,0 +1,244 @@
+#include "sls_solver.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+namespace {
+
+// Break counts above this share one probSAT weight.
+constexpr int max_tabulated_break = 64;
+
+} // namespace
+
+SLSSolver::SLSSolver(const DimacsFormula& formula, const SLSOptions& options)
+    : options(options), num_vars(formula.variable_count), random_state(options.seed ? options.seed : 1) {
+    std::vector<uint32_t> occurrence_count(2 * (size_t)num_vars + 1, 0);
+    size_t max_width = 0;
+
+    std::vector<int> clause;
+    for (size_t i = 0; i < formula.clause_count(); ++i) {
+        clause.assign(formula.clause_begin(i), formula.clause_end(i));
+        bool tautology = normalize_clause(clause);
+        if (tautology) continue;
+        if (clause.empty()) {
+            has_empty_clause = true;
+            continue;
+        }
+        for (int lit : clause) {
+            clause_literals.push_back(lit);
+            occurrence_count[lit_idx(lit) + 1]++;
+        }
+        clause_starts.push_back((uint32_t)clause_literals.size());
+        max_width = std::max(max_width, clause.size());
+    }
+
+    const size_t clause_count = clause_starts.size() - 1;
+    occurrence_starts.assign(occurrence_count.begin(), occurrence_count.end());
+    for (size_t l = 1; l < occurrence_starts.size(); l++) occurrence_starts[l] += occurrence_starts[l - 1];
+    occurrence_list.resize(clause_literals.size());
+    std::vector<uint32_t> fill(occurrence_starts.begin(), occurrence_starts.end() - 1);
+    for (size_t c = 0; c < clause_count; c++) {
+        for (uint32_t k = clause_starts[c]; k < clause_starts[c + 1]; k++) {
+            occurrence_list[fill[lit_idx(clause_literals[k])]++] = (int)c;
+        }
+    }
+
+    values.assign((size_t)num_vars + 1, 0);
+    true_count.assign(clause_count, 0);
+    true_xor.assign(clause_count, 0);
+    break_count.assign((size_t)num_vars + 1, 0);
+    unsat_position.assign(clause_count, -1);
+    unsat_clauses.reserve(clause_count);
+    best_values.assign(num_vars, 0);
+    flip_log.reserve(num_vars);
+    candidates.reserve(max_width);
+    candidate_weight.reserve(max_width);
+    statistics.best_unsatisfied = clause_count + (has_empty_clause ? 1 : 0);
+
+    // The probSAT parameters of Balint and Schoening: the polynomial break
+    // function suits 3-SAT, the exponential one wider clauses.
+    double cb = options.cb;
+    bool polynomial = max_width <= 3;
+    if (cb <= 0.0) cb = polynomial ? 2.06 : (max_width <= 4) ? 3.0 : (max_width <= 6) ? 3.7 : 5.4;
+    break_weight.resize(max_tabulated_break + 1);
+    for (int b = 0; b <= max_tabulated_break; b++) {
+        break_weight[b] = polynomial ? std::pow(options.eps + b, -cb) : std::pow(cb, -b);
+    }
+}
+
+// xorshift64*.
+uint64_t SLSSolver::next_random() {
+    random_state ^= random_state >> 12;
+    random_state ^= random_state << 25;
+    random_state ^= random_state >> 27;
+    return random_state * 0x2545F4914F6CDD1Dull;
+}
+
+double SLSSolver::next_unit() {
+    return (double)(next_random() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+void SLSSolver::add_unsat(int clause) {
+    unsat_position[clause] = (int)unsat_clauses.size();
+    unsat_clauses.push_back(clause);
+}
+
+void SLSSolver::remove_unsat(int clause) {
+    int position = unsat_position[clause];
+    int last = unsat_clauses.back();
+    unsat_clauses[position] = last;
+    unsat_position[last] = position;
+    unsat_clauses.pop_back();
+    unsat_position[clause] = -1;
+}
+
+// Draws a fresh assignment and rebuilds every counter from scratch.
+void SLSSolver::randomize_assignment() {
+    for (int v = 1; v <= num_vars; v++) values[v] = (uint8_t)(next_random() >> 63);
+    std::fill(break_count.begin(), break_count.end(), 0);
+    for (int c : unsat_clauses) unsat_position[c] = -1;
+    unsat_clauses.clear();
+
+    for (size_t c = 0; c + 1 < clause_starts.size(); c++) {
+        int count = 0;
+        int critical = 0;
+        for (uint32_t k = clause_starts[c]; k < clause_starts[c + 1]; k++) {
+            int lit = clause_literals[k];
+            int var = std::abs(lit);
+            if (values[var] == (lit > 0)) {
+                count++;
+                critical ^= var;
+            }
+        }
+        true_count[c] = count;
+        true_xor[c] = critical;
+        if (count == 0) add_unsat((int)c);
+        else if (count == 1) break_count[critical]++;
+    }
+    flip_log.clear();
+    log_overflowed = true;
+}
+
+void SLSSolver::flip(int var) {
+    values[var] ^= 1;
+    int made_true = values[var] ? var : -var;
+
+    int index = lit_idx(made_true);
+    for (uint32_t k = occurrence_starts[index]; k < occurrence_starts[index + 1]; k++) {
+        int c = occurrence_list[k];
+        int count = ++true_count[c];
+        if (count == 1) {
+            remove_unsat(c);
+            break_count[var]++;
+        } else if (count == 2) {
+            break_count[true_xor[c]]--;
+        }
+        true_xor[c] ^= var;
+    }
+
+    index = lit_idx(-made_true);
+    for (uint32_t k = occurrence_starts[index]; k < occurrence_starts[index + 1]; k++) {
+        int c = occurrence_list[k];
+        int count = --true_count[c];
+        true_xor[c] ^= var;
+        if (count == 0) {
+            add_unsat(c);
+            break_count[var]--;
+        } else if (count == 1) {
+            break_count[true_xor[c]]++;
+        }
+    }
+
+    statistics.flips++;
+    if (log_overflowed) return;
+    if (flip_log.size() < (size_t)num_vars) flip_log.push_back(var);
+    else log_overflowed = true;
+}
+
+// Brings best_values up to the current assignment, replaying the logged
+// flips when that is cheaper than a full copy.
+void SLSSolver::record_best() {
+    if (log_overflowed) {
+        for (int v = 1; v <= num_vars; v++) best_values[v - 1] = values[v];
+    } else {
+        for (int var : flip_log) best_values[var - 1] = values[var];
+    }
+    flip_log.clear();
+    log_overflowed = false;
+    statistics.best_unsatisfied = unsat_clauses.size();
+}
+
+int SLSSolver::pick_probsat(int clause) {
+    candidates.clear();
+    candidate_weight.clear();
+    double total = 0.0;
+    for (uint32_t k = clause_starts[clause]; k < clause_starts[clause + 1]; k++) {
+        int var = std::abs(clause_literals[k]);
+        total += break_weight[std::min(break_count[var], max_tabulated_break)];
+        candidates.push_back(var);
+        candidate_weight.push_back(total);
+    }
+    double point = next_unit() * total;
+    for (size_t i = 0; i + 1 < candidates.size(); i++) {
+        if (point < candidate_weight[i]) return candidates[i];
+    }
+    return candidates.back();
+}
+
+// WalkSAT/SKC: a free flip if there is one, otherwise a random walk step
+// with probability noise and a least-break flip (ties broken at random).
+int SLSSolver::pick_walksat(int clause) {
+    const uint32_t begin = clause_starts[clause];
+    const uint32_t width = clause_starts[clause + 1] - begin;
+    candidates.clear();
+    int best_break = INT32_MAX;
+    for (uint32_t k = begin; k < begin + width; k++) {
+        int var = std::abs(clause_literals[k]);
+        int b = break_count[var];
+        if (b < best_break) {
+            best_break = b;
+            candidates.clear();
+        }
+        if (b == best_break) candidates.push_back(var);
+    }
+    if (best_break > 0 && next_unit() < options.noise) {
+        return std::abs(clause_literals[begin + next_random() % width]);
+    }
+    return candidates[next_random() % candidates.size()];
+}
+
+bool SLSSolver::solve() {
+    if (has_empty_clause) return false;
+
+    long long flips_this_try = 0;
+    progress.start(options.progress_interval);
+    budget.start(options.limits);
+    randomize_assignment();
+    record_best();
+    while (!unsat_clauses.empty()) {
+        if (statistics.flips >= options.max_flips) return false;
+        if (budget.exhausted(0, 0, 0)) return false;
+        if (options.restart_flips > 0 && flips_this_try >= options.restart_flips) {
+            randomize_assignment();
+            statistics.restarts++;
+            flips_this_try = 0;
+            if (unsat_clauses.size() < statistics.best_unsatisfied) record_best();
+            continue;
+        }
+
+        int clause = unsat_clauses[next_random() % unsat_clauses.size()];
+        int var = (options.algorithm == SLSAlgorithm::probsat) ? pick_probsat(clause) : pick_walksat(clause);
+        flip(var);
+        flips_this_try++;
+        if (unsat_clauses.size() < statistics.best_unsatisfied) record_best();
+
+        if (progress.due()) {
+            std::cout << progress.label() << statistics.flips << " flips, " << unsat_clauses.size()
+                      << " unsatisfied clauses, best " << statistics.best_unsatisfied << std::endl;
+        }
+    }
+    record_best();
+    return true;
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "dimacs_reader.h"
+#include "instrumentation.h"
+#include "budget.h"
+
+#include <cstdint>
+#include <vector>
+
+enum class SLSAlgorithm {
+    probsat,
+    walksat
+};
+
+struct SLSOptions {
+    SLSAlgorithm algorithm = SLSAlgorithm::probsat;
+    // probSAT: a variable is picked with weight (eps + break)^-cb for 3-SAT
+    // and cb^-break for wider clauses. cb 0 picks it from the clause width.
+    double cb = 0.0;
+    double eps = 0.9;
+    // WalkSAT: probability of a random walk step when no flip is free.
+    double noise = 0.567;
+    // Total flip budget, and flips before a fresh random assignment (0 never
+    // restarts).
+    long long max_flips = 100000000;
+    long long restart_flips = 0;
+    uint64_t seed = 1;
+    // Seconds between progress lines, 0 for none.
+    double progress_interval = 0.0;
+    // Time and memory limits on top of max_flips.
+    BudgetLimits limits;
+};
+
+struct SLSStats {
+    long long flips = 0;
+    long long restarts = 0;
+    size_t best_unsatisfied = 0;
+};
+
+// Stochastic local search over complete assignments. Each step picks a
+// random falsified clause and flips one of its variables, chosen by break
+// count: the number of clauses that would become false. Break counts are
+// kept up to date incrementally through the occurrence lists, with the
+// XOR of the true variables of each clause naming the single one of a
+// critically satisfied clause. The falsified clauses are held in a dense
+// set with O(1) insertion and removal. Incomplete: it only ever answers SAT.
+class SLSSolver {
+public:
+    explicit SLSSolver(const DimacsFormula& formula, const SLSOptions& options = SLSOptions());
+
+    // True once an assignment satisfying every clause was found.
+    bool solve();
+
+    // The assignment with the fewest falsified clauses seen so far, 0 or 1
+    // per variable; a model after solve() returned true.
+    const std::vector<int>& best_assignment() const { return best_values; }
+    const SLSStats& stats() const { return statistics; }
+    // The limit that stopped the last solve() early, if any.
+    BudgetLimit budget_exceeded() const { return budget.exceeded(); }
+
+private:
+    SLSOptions options;
+    SLSStats statistics;
+    ProgressClock progress;
+    Budget budget;
+    int num_vars = 0;
+    bool has_empty_clause = false;
+    uint64_t random_state;
+
+    std::vector<int> clause_literals;
+    std::vector<uint32_t> clause_starts{0};
+    // Clause ids by literal index, CSR.
+    std::vector<uint32_t> occurrence_starts;
+    std::vector<int> occurrence_list;
+
+    // values[v] for variable v, 1-based.
+    std::vector<uint8_t> values;
+    std::vector<int> true_count;
+    std::vector<int> true_xor;
+    std::vector<int> break_count;
+    std::vector<int> unsat_clauses;
+    std::vector<int> unsat_position;
+
+    // probSAT weights by break count, and scratch for one clause.
+    std::vector<double> break_weight;
+    std::vector<double> candidate_weight;
+    std::vector<int> candidates;
+
+    // The best assignment is kept current lazily: flips since it was taken
+    // are logged and replayed onto it only when a new best is reached.
+    std::vector<int> best_values;
+    std::vector<int> flip_log;
+    bool log_overflowed = false;
+
+    uint64_t next_random();
+    double next_unit();
+    void randomize_assignment();
+    void flip(int var);
+    int pick_probsat(int clause);
+    int pick_walksat(int clause);
+    void record_best();
+    void add_unsat(int clause);
+    void remove_unsat(int clause);
+};
@@ -0,0 +1,97 @@
+#include "cdcl_solver.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+// Assumptions that repeat or are already implied each open an empty
+// decision level, so the search runs at levels above the variable count.
+// Conflicts learnt up there must still be scored correctly.
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const char* what) {
+    if (!condition) {
+        std::cerr << "FAILED: " << what << "\n";
+        failures++;
+    }
+}
+
+constexpr int selector = 1;
+constexpr int holes = 4;
+constexpr int chain_first = 22;
+constexpr int chain_last = 30;
+
+int pigeon(int i, int j) {
+    return 2 + i * holes + j;
+}
+
+// Pigeonhole with holes + 1 pigeons, switched on by the selector, and an
+// implication chain chain_first -> ... -> chain_last. 30 variables in all.
+std::vector<std::vector<int>> build_clauses() {
+    std::vector<std::vector<int>> clauses;
+    for (int i = 0; i <= holes; i++) {
+        std::vector<int> clause = {-selector};
+        for (int j = 0; j < holes; j++) clause.push_back(pigeon(i, j));
+        clauses.push_back(clause);
+    }
+    for (int j = 0; j < holes; j++) {
+        for (int a = 0; a <= holes; a++) {
+            for (int b = a + 1; b <= holes; b++) clauses.push_back({-selector, -pigeon(a, j), -pigeon(b, j)});
+        }
+    }
+    for (int v = chain_first; v < chain_last; v++) clauses.push_back({-v, v + 1});
+    return clauses;
+}
+
+bool satisfies(const std::vector<std::vector<int>>& clauses, const std::vector<int>& model) {
+    for (const std::vector<int>& clause : clauses) {
+        bool satisfied = std::any_of(clause.begin(), clause.end(), [&model](int literal) {
+            return model[std::abs(literal) - 1] == (literal > 0 ? 1 : 0);
+        });
+        if (!satisfied) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main() {
+    std::vector<std::vector<int>> clauses = build_clauses();
+    SATSolverCDCL solver;
+    for (const std::vector<int>& clause : clauses) solver.add_clause(clause);
+    check(solver.variable_count() == chain_last, "30 variables");
+
+    std::vector<int> repeated(100, selector);
+    check(solver.solve(repeated) == RetVal::r_unsatisfied, "repeated selector is UNSAT");
+    check(solver.failed_assumptions() == std::vector<int>{selector}, "the selector failed");
+
+    // The chain implies every later link once the first is assumed.
+    std::vector<int> implied;
+    for (int round = 0; round < 20; round++) {
+        for (int v = chain_first; v <= chain_last; v++) implied.push_back(v);
+    }
+    implied.push_back(selector);
+    check(solver.solve(implied) == RetVal::r_unsatisfied, "implied assumptions then the selector is UNSAT");
+    const std::vector<int>& failed = solver.failed_assumptions();
+    check(std::find(failed.begin(), failed.end(), selector) != failed.end(), "the selector is among the failed");
+    for (int literal : failed) {
+        check(std::find(implied.begin(), implied.end(), literal) != implied.end(), "failed literals were assumed");
+    }
+
+    std::vector<int> satisfiable(50, chain_first);
+    check(solver.solve(satisfiable) == RetVal::r_satisfied, "repeated chain start is SAT");
+    check(satisfies(clauses, solver.model()), "model satisfies the clauses");
+    check(solver.model()[chain_last - 1] == 1, "model follows the chain");
+    check(solver.model()[selector - 1] == 0, "model switches the pigeonhole off");
+
+    check(solver.solve() == RetVal::r_satisfied, "no assumptions is SAT");
+    check(solver.select_cube_split(std::vector<int>(100, chain_first), 4) >= 0, "repeated cube is not refuted");
+
+    if (failures > 0) return 1;
+    std::cout << "cdcl_assumptions_test passed\n";
+    return 0;
+}
@@ -0,0 +1,72 @@
+#include "clause_kernel.h"
+#include "dimacs_reader.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+// A clause wider than K must be refused rather than cut short, and a
+// repeated literal counts once, both in the kernel and after
+// remove_duplicate_literals.
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const char* what) {
+    if (!condition) {
+        std::cerr << "FAILED: " << what << "\n";
+        failures++;
+    }
+}
+
+bool parse(const char* text, DimacsFormula& formula) {
+    std::string error;
+    if (!parse_dimacs(text, std::char_traits<char>::length(text), formula, error)) {
+        std::cerr << "FAILED: " << error << "\n";
+        failures++;
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main() {
+    DimacsFormula wide;
+    if (parse("p cnf 4 2\n1 2 0\n1 -2 3 4 0\n", wide)) {
+        ClauseKernel<3> kernel;
+        std::string error;
+        check(!kernel.load(wide, error), "a 4-literal clause is refused by ClauseKernel<3>");
+        check(!error.empty(), "the refusal says why");
+        check(kernel.clause_count() == 0, "a refused formula leaves no clauses");
+        check(max_clause_width(wide) == 4, "max_clause_width is 4");
+    }
+
+    // Three literals as written, two distinct: x1 false makes the first
+    // clause unit and the second conflicting.
+    DimacsFormula repeated;
+    if (parse("p cnf 2 2\n1 1 2 0\n1 1 1 0\n", repeated)) {
+        check(max_clause_width(repeated) == 2, "repeated literals count once in the width");
+        ClauseKernel<2> kernel;
+        std::string error;
+        check(kernel.load(repeated, error), "ClauseKernel<2> takes clauses with two distinct literals");
+        kernel.set_assignment({0, -1});
+        std::vector<uint8_t> status(2);
+        for (KernelIsa isa : {KernelIsa::scalar, KernelIsa::sse2, KernelIsa::avx2}) {
+            if (isa > best_kernel_isa()) break;
+            kernel.classify(status.data(), isa);
+            check(status[0] == CLAUSE_UNIT, "1 1 2 is unit under -1");
+            check(status[1] == CLAUSE_CONFLICT, "1 1 1 conflicts under -1");
+        }
+
+        remove_duplicate_literals(repeated);
+        check(repeated.clause_count() == 2, "normalizing keeps every clause");
+        check(repeated.clause_size(0) == 2 && repeated.clause_size(1) == 1, "normalizing drops repeats");
+        check(repeated.literals == std::vector<int>({1, 2, 1}), "normalized literals are sorted");
+    }
+
+    if (failures > 0) return 1;
+    std::cout << "clause_kernel_test passed\n";
+    return 0;
+}
@@ -0,0 +1,69 @@
+#include "dimacs_reader.h"
+
+#include <iostream>
+#include <string>
+
+// The header is not trusted: negative counts and a second problem line are
+// refused, a header that names fewer variables than the clauses use does
+// not shrink variable_count, and a huge clause count does not size buffers.
+// validate_formula catches what a hand-built formula can get wrong.
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const char* what) {
+    if (!condition) {
+        std::cerr << "FAILED: " << what << "\n";
+        failures++;
+    }
+}
+
+bool parse(const std::string& text, DimacsFormula& formula, std::string& error) {
+    return parse_dimacs(text.data(), text.size(), formula, error);
+}
+
+} // namespace
+
+int main() {
+    DimacsFormula formula;
+    std::string error;
+
+    check(!parse("p cnf -4 0\n", formula, error), "negative variable count is refused");
+    check(error.find("malformed problem line") != std::string::npos, "negative variable count is a malformed problem line");
+    error.clear();
+    check(!parse("p cnf 4 -1\n1 0\n", formula, error), "negative clause count is refused");
+    check(error.find("malformed problem line") != std::string::npos, "negative clause count is a malformed problem line");
+
+    error.clear();
+    check(!parse("p cnf 5 2\n1 -5 2 0\np cnf 2 1\n-1 2 -3 0\n", formula, error), "a second problem line is refused");
+    check(error.find("second problem line") != std::string::npos, "the error names the second problem line");
+
+    // The only header comes after clauses and undercounts: the clauses win.
+    check(parse("1 -5 2 0\n5 3 0\np cnf 2 1\n-1 2 -3 0\n", formula, error), "a late header is accepted");
+    check(formula.variable_count == 5, "a late header does not lower variable_count");
+    check(formula.clause_count() == 3, "clauses on both sides of the header are read");
+
+    check(parse("p cnf 3 1\n1 -7 0\n", formula, error), "an undercounting header is accepted");
+    check(formula.variable_count == 7, "variable_count is raised to the largest variable");
+
+    DimacsFormula fresh;
+    check(parse("p cnf 1 2000000000\n1 0\n", fresh, error), "an overcounting header is accepted");
+    check(fresh.clause_count() == 1, "an overcounting header reads the one clause");
+    check(fresh.clause_starts.capacity() < 1000 && fresh.literals.capacity() < 1000,
+          "buffers are sized by the input, not by the header");
+
+    DimacsFormula built;
+    built.variable_count = 2;
+    built.literals = {1, -3};
+    built.clause_starts = {0, 2};
+    check(!validate_formula(built, error), "a literal past variable_count is caught");
+    built.variable_count = 3;
+    check(validate_formula(built, error), "a consistent formula validates");
+    built.clause_starts = {0, 3};
+    check(!validate_formula(built, error), "offsets past the literals are caught");
+
+    if (failures > 0) return 1;
+    std::cout << "dimacs_reader_test passed\n";
+    return 0;
+}
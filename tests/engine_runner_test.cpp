@@ -0,0 +1,59 @@
+#include "engine_runner.h"
+
+#include <atomic>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// Runs started from several threads must not leak their pipes into each
+// other's children. A leaked write end keeps a reader waiting until the
+// unrelated child exits; the window for that is narrow, but a run's read
+// end stays open in this process for the whole run. So while one thread
+// has a slow run in flight, children started from another count the
+// descriptors above stderr that they inherited. The count is reported as
+// the solve time.
+
+namespace {
+
+const std::string shell = "/bin/sh";
+const std::vector<std::string> count_descriptors = {
+    "-c", "n=0; for fd in 3 4 5 6 7 8 9; do if (true <&$fd) 2>/dev/null; then n=$((n+1)); fi; done; "
+          "echo \"UNSAT in $n ms\""};
+const std::vector<std::string> slow = {"-c", "sleep 0.5; echo 'SAT in 500 ms'"};
+
+} // namespace
+
+int main() {
+    // Whatever this process was started with is inherited either way.
+    RunResult baseline = run_engine(shell, count_descriptors, "baseline", 10.0);
+    if (baseline.result != "UNSAT") {
+        std::cerr << "FAILED: could not read the baseline run\n";
+        return 1;
+    }
+
+    std::atomic<bool> slow_running{true};
+    std::atomic<bool> slow_ok{false};
+    std::thread slow_thread([&]() {
+        slow_ok = run_engine(shell, slow, "slow", 10.0).result == "SAT";
+        slow_running = false;
+    });
+
+    int runs = 0;
+    int leaks = 0;
+    int misread = 0;
+    while (slow_running) {
+        RunResult run = run_engine(shell, count_descriptors, "probe", 10.0);
+        runs++;
+        if (run.result != "UNSAT") misread++;
+        else if (run.solve_ms > baseline.solve_ms) leaks++;
+    }
+    slow_thread.join();
+
+    if (leaks > 0 || misread > 0 || !slow_ok) {
+        std::cerr << "FAILED: " << leaks << " of " << runs << " runs inherited another run's pipe, " << misread
+                  << " misread, slow run " << (slow_ok ? "ok" : "misread") << "\n";
+        return 1;
+    }
+    std::cout << "engine_runner_test passed (" << runs << " runs)\n";
+    return 0;
+}
@@ -0,0 +1,140 @@
+#include "cdcl_solver.h"
+#include "dimacs_reader.h"
+#include "preprocessor.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Preprocesses satisfiable formulas, solves the reduced formula and maps
+// its model back, both directly and through a written and reread variable
+// map. The mapped model must satisfy the original clauses. Runs on a small
+// formula with fixed, renamed and unused variables, and on every *_sat.cnf
+// under the directories given on the command line.
+
+namespace fs = std::filesystem;
+
+namespace {
+
+bool satisfies(const DimacsFormula& formula, const std::vector<int>& model) {
+    for (size_t i = 0; i < formula.clause_count(); i++) {
+        bool satisfied = std::any_of(formula.clause_begin(i), formula.clause_end(i), [&model](int literal) {
+            return model[std::abs(literal) - 1] == (literal > 0 ? 1 : 0);
+        });
+        if (!satisfied) return false;
+    }
+    return true;
+}
+
+// Returns false with a message on failure; sets skipped if the solver ran
+// out of its conflict budget.
+bool check_formula(const DimacsFormula& original, std::string& failure, bool& skipped) {
+    Preprocessor preprocessor;
+    DimacsFormula reduced;
+    if (!preprocessor.run(original, reduced)) {
+        failure = "preprocessor refuted a satisfiable formula";
+        return false;
+    }
+
+    SATSolverCDCL solver;
+    solver.initialize(reduced);
+    solver.set_conflict_budget(200000);
+    int result = solver.solve();
+    if (result == RetVal::r_unknown) {
+        skipped = true;
+        return true;
+    }
+    if (result != RetVal::r_satisfied) {
+        failure = "reduced formula is not satisfiable";
+        return false;
+    }
+    std::vector<int> reduced_model = solver.model();
+    reduced_model.resize(reduced.variable_count, 0);
+    if (!satisfies(reduced, reduced_model)) {
+        failure = "solver model does not satisfy the reduced formula";
+        return false;
+    }
+
+    std::vector<int> model = preprocessor.map_model(reduced_model);
+    if (model.size() != (size_t)original.variable_count || !satisfies(original, model)) {
+        failure = "mapped model does not satisfy the original formula";
+        return false;
+    }
+
+    std::stringstream map;
+    preprocessor.write_map(map);
+    Preprocessor reloaded;
+    std::string error;
+    if (!reloaded.read_map(map, error)) {
+        failure = "written map does not read back: " + error;
+        return false;
+    }
+    if (reloaded.map_model(reduced_model) != model) {
+        failure = "reread map gives a different model";
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int failures = 0;
+    int checked = 0;
+    int skipped_count = 0;
+
+    // 1 is a unit, -3 fails by probing (it implies 4 and -4), 5 occurs in no
+    // clause, and duplicates and a tautology disappear.
+    const char* text = "p cnf 8 9\n1 0\n-1 2 6 0\n3 4 0\n3 -4 0\n2 6 7 0\n2 6 7 0\n7 -7 8 0\n-6 -7 8 0\n6 -8 -2 0\n";
+    DimacsFormula small;
+    std::string error;
+    if (!parse_dimacs(text, std::char_traits<char>::length(text), small, error)) {
+        std::cerr << "FAILED: built-in formula: " << error << "\n";
+        return 1;
+    }
+    std::vector<std::pair<std::string, DimacsFormula>> formulas;
+    formulas.emplace_back("built-in", std::move(small));
+
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; i++) {
+        std::error_code ignored;
+        for (const auto& entry : fs::recursive_directory_iterator(argv[i], ignored)) {
+            std::string stem = entry.path().stem().string();
+            if (entry.path().extension() == ".cnf" && stem.size() > 4 && stem.compare(stem.size() - 4, 4, "_sat") == 0) {
+                paths.push_back(entry.path().string());
+            }
+        }
+    }
+    std::sort(paths.begin(), paths.end());
+
+    auto check = [&](const std::string& name, const DimacsFormula& formula) {
+        std::string failure;
+        bool skipped = false;
+        if (!check_formula(formula, failure, skipped)) {
+            std::cerr << "FAILED: " << name << ": " << failure << "\n";
+            failures++;
+        } else if (skipped) {
+            skipped_count++;
+        } else {
+            checked++;
+        }
+    };
+    check(formulas[0].first, formulas[0].second);
+    for (const std::string& path : paths) {
+        DimacsFormula formula;
+        if (!read_dimacs(path, formula, error)) {
+            std::cerr << "FAILED: " << path << ": " << error << "\n";
+            failures++;
+            continue;
+        }
+        check(path, formula);
+    }
+
+    std::cout << checked << " formulas mapped back, " << skipped_count << " over the conflict budget, " << failures
+              << " failures\n";
+    return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,34 @@
+#!/bin/sh
+# Usage: sat_bench_flags_test.sh <sat_bench> <instance.cnf>
+# Stands a fake dpll_solver in for the real one and checks that sat_bench
+# exits with status 2 when every run crashes, and when the answer flips
+# between repetitions.
+bench=$1
+instance=$2
+dir=$(mktemp -d) || exit 1
+trap 'rm -rf "$dir"' EXIT
+
+expect_flag() {
+    "$bench" --engines dpll --bin-dir "$dir" --warmup 0 --repeat 2 "$instance" > "$dir/out"
+    status=$?
+    if [ "$status" != 2 ] || ! grep -q "$1" "$dir/out"; then
+        echo "FAILED: $2 (status $status)"
+        cat "$dir/out"
+        exit 1
+    fi
+}
+
+printf '#!/bin/sh\nkill -SEGV $$\n' > "$dir/dpll_solver"
+chmod +x "$dir/dpll_solver"
+expect_flag FAILED "a crashing engine is flagged"
+
+cat > "$dir/dpll_solver" <<'SCRIPT'
+#!/bin/sh
+count="$(dirname "$0")/count"
+n=$(cat "$count" 2>/dev/null || echo 0)
+echo $((n + 1)) > "$count"
+if [ $((n % 2)) = 0 ]; then echo "SAT in 1 ms"; else echo "UNSAT in 1 ms"; fi
+SCRIPT
+expect_flag INCONSISTENT "an answer that flips between repetitions is flagged"
+
+echo "sat_bench_flags_test passed"